@@ -49,6 +49,10 @@
 
 #include "cwe_interfacedriver.h"
 #include "cwe_globals.h"
+#include "cwefilechangedispatcher.h"
+#include "cwefileopscheduler.h"
+
+#include "visualUtils/cfdprefetcher.h"
 
 CWEcaseInstance::CWEcaseInstance(const FileNodeRef &newCaseFolder):
     QObject(qobject_cast<QObject *>(cwe_globals::get_CWE_Driver()))
@@ -138,12 +142,11 @@ QMap<QString, StageState> CWEcaseInstance::getStageStates()
     return storedStageStates;
 }
 
-bool CWEcaseInstance::createCase(QString newName, const FileNodeRef &containingFolder)
+bool CWEcaseInstance::createCase(QString newName, const FileNodeRef &containingFolder, QMap<QString, QString> initialParams)
 {
     if (defunct) return false;
 
     if (myState != InternalCaseState::TYPE_SELECTED) return false;
-    if (cwe_globals::get_file_handle()->operationIsPending()) return false;
     if (!caseFolder.isNil()) return false;
     if (!expectedNewCaseFolder.isEmpty()) return false;
 
@@ -153,10 +156,14 @@ bool CWEcaseInstance::createCase(QString newName, const FileNodeRef &containingF
     expectedNewCaseFolder = expectedNewCaseFolder.append("/");
     expectedNewCaseFolder = expectedNewCaseFolder.append(newName);
 
-    cwe_globals::get_file_handle()->sendCreateFolderReq(containingFolder, newName);
+    //Note: The initial parameters go in the first upload of the parameter file
+    initialParamList = initialParams;
 
-    if (!cwe_globals::get_file_handle()->operationIsPending())
+    //Case creation is queued and finished by its op ID, so several cases can be made at once
+    caseOpID = cwe_globals::get_file_op_scheduler()->queueCreateFolder(containingFolder, newName);
+    if (caseOpID < 0)
     {
+        expectedNewCaseFolder.clear();
         return false;
     }
 
@@ -171,7 +178,6 @@ bool CWEcaseInstance::duplicateCase(QString newName, const FileNodeRef &containi
     if (myState != InternalCaseState::EMPTY_CASE) return false;
     if (!containingFolder.fileNodeExtant()) return false;
     if (!oldCase.fileNodeExtant()) return false;
-    if (cwe_globals::get_file_handle()->operationIsPending()) return false;
     if (!caseFolder.isNil()) return false;
     if (!expectedNewCaseFolder.isEmpty()) return false;
 
@@ -179,10 +185,10 @@ bool CWEcaseInstance::duplicateCase(QString newName, const FileNodeRef &containi
     expectedNewCaseFolder = expectedNewCaseFolder.append("/");
     expectedNewCaseFolder = expectedNewCaseFolder.append(newName);
 
-    cwe_globals::get_file_handle()->sendCopyReq(oldCase, expectedNewCaseFolder);
-
-    if (!cwe_globals::get_file_handle()->operationIsPending())
+    caseOpID = cwe_globals::get_file_op_scheduler()->queueCopy(oldCase, expectedNewCaseFolder);
+    if (caseOpID < 0)
     {
+        expectedNewCaseFolder.clear();
         return false;
     }
 
@@ -196,22 +202,16 @@ bool CWEcaseInstance::changeParameters(QMap<QString, QString> paramList)
 
     if (myState != InternalCaseState::READY) return false;
     if (!caseFolder.fileNodeExtant()) return false;
-    if (cwe_globals::get_file_handle()->operationIsPending()) return false;
 
     const FileNodeRef varStore = caseFolder.getChildWithName(caseParamFileName);
     QByteArray fileData = varStore.getFileBuffer();
 
     prospectiveNewParamList.clear();
 
-    QJsonDocument varDoc = QJsonDocument::fromJson(fileData);
-    if (!varDoc.isNull())
+    refreshParamCache(fileData);
+    if (paramCacheValid)
     {
-        QJsonObject varsList = varDoc.object().value("vars").toObject();
-
-        for (auto itr = varsList.constBegin(); itr != varsList.constEnd(); itr++)
-        {
-            prospectiveNewParamList.insert(itr.key(),(*itr).toString());
-        }
+        prospectiveNewParamList = paramCacheVars;
     }
 
     for (auto itr = paramList.constBegin(); itr != paramList.constEnd(); itr++)
@@ -226,9 +226,10 @@ bool CWEcaseInstance::changeParameters(QMap<QString, QString> paramList)
         }
     }
 
+    //The save waits in the file op queue rather than failing on other running operations
     QByteArray newFile = produceJSONparams(prospectiveNewParamList);
-    cwe_globals::get_file_handle()->sendUploadBuffReq(caseFolder, newFile, caseParamFileName);
-    if (!cwe_globals::get_file_handle()->operationIsPending())
+    paramSaveOpID = cwe_globals::get_file_op_scheduler()->queueBufferUpload(caseFolder, newFile, caseParamFileName);
+    if (paramSaveOpID < 0)
     {
         return false;
     }
@@ -292,15 +293,13 @@ bool CWEcaseInstance::rollBack(QString stageToDelete)
     if ((storedStageStates.value(stageToDelete, StageState::ERROR) != StageState::FINISHED) &&
             (storedStageStates.value(stageToDelete, StageState::ERROR) != StageState::ERROR))
         return false;
-    if (cwe_globals::get_file_handle()->operationIsPending()) return false;
 
     const FileNodeRef folderToRemove = caseFolder.getChildWithName(stageToDelete);
 
     if (folderToRemove.isNil()) return false;
 
-    cwe_globals::get_file_handle()->sendDeleteReq(folderToRemove);
-
-    if (!cwe_globals::get_file_handle()->operationIsPending()) return false;
+    caseOpID = cwe_globals::get_file_op_scheduler()->queueDelete(folderToRemove);
+    if (caseOpID < 0) return false;
 
     runningStage = stageToDelete;
     emitNewState(InternalCaseState::WAITING_FOLDER_DEL);
@@ -332,11 +331,10 @@ bool CWEcaseInstance::downloadCase(QString destLocalFile)
     if ((myState != InternalCaseState::READY) &&
             (myState != InternalCaseState::READY_ERROR)) return false;
     if (myType == nullptr) return false;
-    if (cwe_globals::get_file_handle()->operationIsPending()) return false;
 
     if (!cwe_globals::isValidLocalFolder(destLocalFile))
     {
-        cwe_globals::displayPopup("Please select a valid local folder for download", "I/O Error");
+        casePopup("Please select a valid local folder for download", "I/O Error");
         return false;
     }
 
@@ -353,19 +351,27 @@ bool CWEcaseInstance::downloadCase(QString destLocalFile)
 
     if (lastCompleteNode.isNil()) return false;
 
-    cwe_globals::get_file_handle()->getRecursiveOp()->enactRecursiveDownload(lastCompleteNode, destLocalFile);
-    if (!cwe_globals::get_file_handle()->operationIsPending()) return false;
+    caseOpID = cwe_globals::get_file_op_scheduler()->queueFolderDownload(lastCompleteNode, destLocalFile);
+    if (caseOpID < 0) return false;
 
     emitNewState(InternalCaseState::DOWNLOAD);
     return true;
 }
 
+void CWEcaseInstance::setErrorPopups(bool showPopups)
+{
+    errorPopups = showPopups;
+}
+
 void CWEcaseInstance::underlyingFilesInterlock(const FileNodeRef changedNode)
 {
-    if (interlockHasFileChange) return;
     if (defunct) return;
     if (caseFolder.isNil()) return;
 
+    markStagesChanged(changedNode);
+
+    if (interlockHasFileChange) return;
+
     if (!caseFolder.fileNodeExtant())
     {
         emitNewState(InternalCaseState::DEFUNCT);
@@ -422,68 +428,77 @@ void CWEcaseInstance::jobListUpdated()
     }
 }
 
-void CWEcaseInstance::fileTaskDone(RequestState invokeStatus)
+void CWEcaseInstance::fileTaskDone(RequestState)
 {
     if (defunct) return;
 
-    if (invokeStatus == RequestState::REMOTE_SERVER_ERROR)
-    {
-        emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("DesignSafe file service has experienced internal error. Connection Lost. If problem persists, please contact developers.", "Network Connection Error");
-        return;
-    }
-    if (invokeStatus != RequestState::GOOD)
+    //The case's own operations are queued, and finished by their op IDs in scheduledOpDone.
+    //Any other file operation ending only matters if it was holding up this case.
+    if (myState == InternalCaseState::EXTERN_FILE_OP)
     {
-        emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Lost connection to DesignSafe. Please check network and try again.", "Network Connection Error");
-        return;
+        state_ExternOp_taskDone();
     }
+}
+
+void CWEcaseInstance::fileTaskStarted()
+{
+    if (defunct) return;
 
     InternalCaseState activeState = myState;
 
     switch (activeState)
     {
-    case InternalCaseState::COPYING_FOLDER:
-        state_CopyingFolder_taskDone(invokeStatus); return;
-
-    case InternalCaseState::EXTERN_FILE_OP:
-        state_ExternOp_taskDone(); return;
-
-    case InternalCaseState::INIT_PARAM_UPLOAD:
-        state_InitParam_taskDone(invokeStatus); return;
-
-    case InternalCaseState::MAKING_FOLDER:
-        state_MakingFolder_taskDone(invokeStatus); return;
-
-    case InternalCaseState::WAITING_FOLDER_DEL:
-        state_WaitingFolderDel_taskDone(invokeStatus); return;
-
-    case InternalCaseState::DOWNLOAD:
-        state_Download_recursiveOpDone(invokeStatus); return;
-
-    case InternalCaseState::PARAM_SAVE:
-        state_Param_Save_taskDone(invokeStatus); return;
+    case InternalCaseState::READY:
+    case InternalCaseState::READY_ERROR:
+        state_Ready_fileChange_jobList(); return;
 
     default:
         return;
     }
 }
 
-void CWEcaseInstance::fileTaskStarted()
+void CWEcaseInstance::scheduledOpDone(int opID, bool opSucceeded)
 {
     if (defunct) return;
 
-    InternalCaseState activeState = myState;
-
-    switch (activeState)
+    if (opID == caseOpID)
     {
-    case InternalCaseState::READY:
-    case InternalCaseState::READY_ERROR:
-        state_Ready_fileChange_jobList(); return;
+        caseOpID = -1;
 
-    default:
+        switch (myState)
+        {
+        case InternalCaseState::MAKING_FOLDER:
+            state_MakingFolder_taskDone(opSucceeded); return;
+
+        case InternalCaseState::INIT_PARAM_UPLOAD:
+            state_InitParam_taskDone(opSucceeded); return;
+
+        case InternalCaseState::COPYING_FOLDER:
+            state_CopyingFolder_taskDone(opSucceeded); return;
+
+        case InternalCaseState::WAITING_FOLDER_DEL:
+            state_WaitingFolderDel_taskDone(opSucceeded); return;
+
+        case InternalCaseState::DOWNLOAD:
+            state_Download_recursiveOpDone(opSucceeded); return;
+
+        default:
+            return;
+        }
+    }
+
+    if (opID == paramSaveOpID)
+    {
+        paramSaveOpID = -1;
+        state_Param_Save_taskDone(opSucceeded);
         return;
     }
+
+    //Queued operations sent on the connection do not end with fileOpDone
+    if (myState == InternalCaseState::EXTERN_FILE_OP)
+    {
+        state_ExternOp_taskDone();
+    }
 }
 
 void CWEcaseInstance::jobInvoked(RequestState invokeStatus, QJsonDocument jobData)
@@ -493,13 +508,13 @@ void CWEcaseInstance::jobInvoked(RequestState invokeStatus, QJsonDocument jobDat
     if (invokeStatus == RequestState::REMOTE_SERVER_ERROR)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("DesignSafe job service has experienced internal error. Connection Lost. If problem persists, please contact developers.", "Network Connection Error");
+        casePopup("DesignSafe job service has experienced internal error. Connection Lost. If problem persists, please contact developers.", "Network Connection Error");
         return;
     }
     if (invokeStatus != RequestState::GOOD)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Lost connection to DesignSafe. Please check network and try again.", "Network Connection Error");
+        casePopup("Lost connection to DesignSafe. Please check network and try again.", "Network Connection Error");
         return;
     }
 
@@ -524,13 +539,13 @@ void CWEcaseInstance::jobKilled(RequestState invokeStatus)
     if (invokeStatus == RequestState::REMOTE_SERVER_ERROR)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("DesignSafe job service has experienced internal error. Connection Lost. If problem persists, please contact developers.", "Network Connection Error");
+        casePopup("DesignSafe job service has experienced internal error. Connection Lost. If problem persists, please contact developers.", "Network Connection Error");
         return;
     }
     if (invokeStatus != RequestState::GOOD)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Lost connection to DesignSafe. Please check network and try again.", "Network Connection Error");
+        casePopup("Lost connection to DesignSafe. Please check network and try again.", "Network Connection Error");
         return;
     }
 
@@ -648,8 +663,8 @@ bool CWEcaseInstance::caseDataInvalid()
         return false;
     }
 
-    QJsonDocument varDoc = QJsonDocument::fromJson(varStore);
-    QString templateName = varDoc.object().value("type").toString();
+    refreshParamCache(varStore);
+    QString templateName = paramCacheTemplate;
     if (templateName.isEmpty())
     {
         return true;
@@ -677,10 +692,8 @@ void CWEcaseInstance::computeCaseType()
     if (varFile.isNil()) return;
 
     if (!varFile.fileBufferLoaded()) return;
-    QByteArray varStore = varFile.getFileBuffer();
-
-    QJsonDocument varDoc = QJsonDocument::fromJson(varStore);
-    QString templateName = varDoc.object().value("type").toString();
+    refreshParamCache(varFile.getFileBuffer());
+    QString templateName = paramCacheTemplate;
     if (templateName.isEmpty())
     {
         return;
@@ -723,10 +736,84 @@ bool CWEcaseInstance::updateStageStatesIfNew(QMap<QString, StageState> * newStag
     {
         return false;
     }
+
+    //Stages which have just finished may have their results fetched ahead of time.
+    //Only a stage seen unfinished counts: one found finished as the case loads is old.
+    for (auto itr = newStageStates->cbegin(); itr != newStageStates->cend(); itr++)
+    {
+        StageState newState = (*itr);
+        if ((newState == StageState::LOADING) || (newState == StageState::DOWNLOADING) ||
+                (newState == StageState::OFFLINE))
+        {
+            continue;
+        }
+
+        bool wasUnfinished = false;
+        if (settledStageStates.contains(itr.key()))
+        {
+            StageState oldState = settledStageStates.value(itr.key());
+            wasUnfinished = ((oldState == StageState::RUNNING) || (oldState == StageState::UNRUN) ||
+                             (oldState == StageState::UNREADY) || (oldState == StageState::ERROR));
+        }
+        settledStageStates[itr.key()] = newState;
+
+        if (!wasUnfinished) continue;
+        if ((newState != StageState::FINISHED) && (newState != StageState::FINISHED_PREREQ)) continue;
+        if (!cwe_globals::get_prefetcher()->isEnabled()) continue;
+
+        cwe_globals::get_prefetcher()->stageFinished(caseFolder, myType->getStageFromId(itr.key()).resultList);
+    }
+
     storedStageStates = *newStageStates;
     return true;
 }
 
+void CWEcaseInstance::markStagesChanged(const FileNodeRef changedNode)
+{
+    //A change under <case>/<stage>/ only touches that stage.
+    //Anything else may touch all of them.
+    if (changedNode.isNil() || caseFolder.isNil())
+    {
+        allStagesChanged = true;
+        return;
+    }
+
+    QString casePath = caseFolder.getFullPath();
+    QString changedPath = changedNode.getFullPath();
+    if (!casePath.endsWith('/')) casePath.append('/');
+
+    if (!changedPath.startsWith(casePath))
+    {
+        allStagesChanged = true;
+        return;
+    }
+
+    QString stageName = changedPath.mid(casePath.length()).section('/', 0, 0, QString::SectionSkipEmpty);
+    if (stageName.isEmpty())
+    {
+        allStagesChanged = true;
+        return;
+    }
+    changedStages.insert(stageName);
+}
+
+StageState CWEcaseInstance::computeStageFileState(QString stageID)
+{
+    //Note: This only looks at the stage's own files. The running stage and
+    //the prerequisite flags are applied after, in recomputeStageStates.
+    FileNodeRef checkNode = caseFolder.getChildWithName(stageID);
+    if (checkNode.isNil()) return StageState::UNRUN;
+
+    const FileNodeRef exitFile = checkNode.getChildWithName(exitFileName);
+    if (exitFile.isNil()) return StageState::ERROR;
+    if (!exitFile.fileBufferLoaded()) return StageState::ERROR;
+
+    const QByteArray exitBytes = exitFile.getFileBuffer();
+    if (QString::fromLatin1(exitBytes) != "0\n") return StageState::ERROR;
+
+    return StageState::FINISHED;
+}
+
 bool CWEcaseInstance::recomputeStageStates()
 {
     //Return true if stage states have changed
@@ -737,10 +824,26 @@ bool CWEcaseInstance::recomputeStageStates()
     if (defunct) return false;
     if (myType == nullptr) return false;
 
+    CaseState currentState = getCaseState();
+
+    //Stage states only depend on the case state, the running stage and the
+    //files in each stage folder. If none of these changed, neither did they.
+    bool folderLoaded = (!caseFolder.isNil() && caseFolder.folderContentsLoaded());
+    if (stageInputsKnown && !allStagesChanged && changedStages.isEmpty() &&
+            (lastCaseState == currentState) && (lastInternalState == myState) &&
+            (lastRunningStage == runningStage) && (lastFolderLoaded == folderLoaded))
+    {
+        return false;
+    }
+    stageInputsKnown = true;
+    lastCaseState = currentState;
+    lastInternalState = myState;
+    lastRunningStage = runningStage;
+    lastFolderLoaded = folderLoaded;
+
     QMap<QString, StageState> newStageStates;
 
     QStringList stageList = myType->getStageIds();
-    CaseState currentState = getCaseState();
 
     if ((currentState == CaseState::DOWNLOAD) ||
             (currentState == CaseState::ERROR) ||
@@ -799,40 +902,31 @@ bool CWEcaseInstance::recomputeStageStates()
     }
 
     //Check known files for expected result files
-    for (auto itr = stageList.begin(); itr != stageList.cend(); itr++)
+    //Only stages with changed files are looked at again
+    if (allStagesChanged)
     {
-        if (newStageStates[*itr] != StageState::LOADING)
-        {
-            continue;
-        }
-
-        FileNodeRef checkNode = caseFolder.getChildWithName(*itr);
-        if (checkNode.isNil())
-        {
-            newStageStates[*itr] = StageState::UNRUN;
-            continue;
-        }
+        stageFileStates.clear();
+    }
+    for (QString aStage : changedStages)
+    {
+        stageFileStates.remove(aStage);
+    }
+    allStagesChanged = false;
+    changedStages.clear();
 
-        const FileNodeRef exitFile = checkNode.getChildWithName(exitFileName);
-        if (exitFile.isNil())
-        {
-            newStageStates[*itr] = StageState::ERROR;
-            continue;
-        }
-        if (!exitFile.fileBufferLoaded())
+    for (auto itr = stageList.begin(); itr != stageList.cend(); itr++)
+    {
+        if (!stageFileStates.contains(*itr))
         {
-            newStageStates[*itr] = StageState::ERROR;
-            continue;
+            stageFileStates.insert(*itr, computeStageFileState(*itr));
         }
-        const QByteArray exitBytes = exitFile.getFileBuffer();
 
-        if (QString::fromLatin1(exitBytes) != "0\n")
+        if (newStageStates[*itr] != StageState::LOADING)
         {
-            newStageStates[*itr] = StageState::ERROR;
             continue;
         }
 
-        newStageStates[*itr] = StageState::FINISHED;
+        newStageStates[*itr] = stageFileStates.value(*itr);
     }
 
     for (int i = 0; i < stageList.length(); i++)
@@ -874,23 +968,47 @@ void CWEcaseInstance::computeParamList()
     if (!caseDataLoaded()) return;
 
     FileNodeRef varFile = caseFolder.getChildWithName(caseParamFileName);
-    QByteArray varStore = varFile.getFileBuffer();
+    refreshParamCache(varFile.getFileBuffer());
 
-    QJsonDocument varDoc = QJsonDocument::fromJson(varStore);
-
-    if (varDoc.isNull())
+    if (!paramCacheValid)
     {
         emitNewState(InternalCaseState::ERROR);
         return;
     }
 
-    QJsonObject varsList = varDoc.object().value("vars").toObject();
-    storedParamList.clear();
+    storedParamList = paramCacheVars;
     prospectiveNewParamList.clear();
+}
+
+void CWEcaseInstance::refreshParamCache(const QByteArray &paramBuffer)
+{
+    //The parameter file is parsed again only when its buffer changes.
+    //A shared buffer is matched by its data pointer, before comparing contents.
+    if (paramCacheFilled && (paramBuffer.size() == paramCacheBuffer.size()))
+    {
+        if (paramBuffer.constData() == paramCacheBuffer.constData()) return;
+        if (paramBuffer == paramCacheBuffer)
+        {
+            paramCacheBuffer = paramBuffer;
+            return;
+        }
+    }
+
+    paramCacheFilled = true;
+    paramCacheBuffer = paramBuffer;
+    paramCacheTemplate.clear();
+    paramCacheVars.clear();
+
+    QJsonDocument varDoc = QJsonDocument::fromJson(paramBuffer);
+    paramCacheValid = !varDoc.isNull();
+    if (!paramCacheValid) return;
 
+    paramCacheTemplate = varDoc.object().value("type").toString();
+
+    QJsonObject varsList = varDoc.object().value("vars").toObject();
     for (auto itr = varsList.constBegin(); itr != varsList.constEnd(); itr++)
     {
-        storedParamList.insert(itr.key(),(*itr).toString());
+        paramCacheVars.insert(itr.key(),(*itr).toString());
     }
 }
 
@@ -926,25 +1044,42 @@ void CWEcaseInstance::connectCaseSignals()
     QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileOpDone(RequestState, QString)),
                      this, SLOT(fileTaskDone(RequestState)),
                      Qt::QueuedConnection);
-    QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileSystemChange(FileNodeRef)),
-                     this, SLOT(underlyingFilesInterlock(FileNodeRef)),
-                     Qt::QueuedConnection);
     QObject::connect(this, SIGNAL(underlyingFilesInterlockSignal()),
                      this, SLOT(underlyingFilesUpdated()),
                      Qt::QueuedConnection);
     QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileOpStarted()),
                      this, SLOT(fileTaskStarted()),
                      Qt::QueuedConnection);
+    QObject::connect(cwe_globals::get_file_op_scheduler(), SIGNAL(opStarted(int)),
+                     this, SLOT(fileTaskStarted()),
+                     Qt::QueuedConnection);
+    QObject::connect(cwe_globals::get_file_op_scheduler(), SIGNAL(opFinished(int,bool,QString)),
+                     this, SLOT(scheduledOpDone(int,bool)),
+                     Qt::QueuedConnection);
+    watchCaseFolder();
+}
+
+void CWEcaseInstance::watchCaseFolder()
+{
+    allStagesChanged = true;
+
+    //Until the case folder is known, all file changes are watched
+    QString watchPath;
+    if (!caseFolder.isNil())
+    {
+        watchPath = caseFolder.getFullPath();
+    }
+    cwe_globals::get_file_dispatcher()->subscribe(watchPath, this, SLOT(underlyingFilesInterlock(FileNodeRef)));
 }
 
-void CWEcaseInstance::state_CopyingFolder_taskDone(RequestState invokeStatus)
+void CWEcaseInstance::state_CopyingFolder_taskDone(bool opSucceeded)
 {
     if (myState != InternalCaseState::COPYING_FOLDER) return;
 
-    if (invokeStatus != RequestState::GOOD)
+    if (!opSucceeded)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Unable to create new folder for case. Please try again.", "Error");
+        casePopup("Unable to create new folder for case. Please try again.", "Error");
         return;
     }
 
@@ -952,10 +1087,11 @@ void CWEcaseInstance::state_CopyingFolder_taskDone(RequestState invokeStatus)
     if (caseFolder.isNil())
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Unable to find case folder info. Please reset and try again.", "Network Issue");
+        casePopup("Unable to find case folder info. Please reset and try again.", "Network Issue");
         return;
     }
     expectedNewCaseFolder.clear();
+    watchCaseFolder();
     computeIdleState();
 }
 
@@ -973,14 +1109,14 @@ void CWEcaseInstance::state_ExternOp_taskDone()
     computeIdleState();
 }
 
-void CWEcaseInstance::state_InitParam_taskDone(RequestState invokeStatus)
+void CWEcaseInstance::state_InitParam_taskDone(bool opSucceeded)
 {
     if (myState != InternalCaseState::INIT_PARAM_UPLOAD) return;
 
-    if (invokeStatus != RequestState::GOOD)
+    if (!opSucceeded)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Unable to upload parameters to new case. Please check connection try again with new case.", "Network Error");
+        casePopup("Unable to upload parameters to new case. Please check connection try again with new case.", "Network Error");
         return;
     }
 
@@ -990,14 +1126,14 @@ void CWEcaseInstance::state_InitParam_taskDone(RequestState invokeStatus)
     computeIdleState();
 }
 
-void CWEcaseInstance::state_MakingFolder_taskDone(RequestState invokeStatus)
+void CWEcaseInstance::state_MakingFolder_taskDone(bool opSucceeded)
 {
     if (myState != InternalCaseState::MAKING_FOLDER) return;
 
-    if (invokeStatus != RequestState::GOOD)
+    if (!opSucceeded)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Error: Unable to create folder for new case. Please check your new folder name and try again.", "Remote Filesystem error");
+        casePopup("Error: Unable to create folder for new case. Please check your new folder name and try again.", "Remote Filesystem error");
         return;
     }
 
@@ -1005,20 +1141,20 @@ void CWEcaseInstance::state_MakingFolder_taskDone(RequestState invokeStatus)
     if (caseFolder.isNil())
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Error: Internal record of new case folder does not exist. Please contact developer to fix bug.", "Internal ERROR");
+        casePopup("Error: Internal record of new case folder does not exist. Please contact developer to fix bug.", "Internal ERROR");
         return;
     }
     expectedNewCaseFolder.clear();
+    watchCaseFolder();
 
-    QMap<QString, QString> allVars;
-    QByteArray newFile = produceJSONparams(allVars);
+    QByteArray newFile = produceJSONparams(initialParamList);
+    initialParamList.clear();
 
-    cwe_globals::get_file_handle()->sendUploadBuffReq(caseFolder, newFile, caseParamFileName);
-
-    if (!cwe_globals::get_file_handle()->operationIsPending())
+    caseOpID = cwe_globals::get_file_op_scheduler()->queueBufferUpload(caseFolder, newFile, caseParamFileName);
+    if (caseOpID < 0)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Unable to contact DesignSafe. Please wait and try again.", "Network Issue");
+        casePopup("Unable to contact DesignSafe. Please wait and try again.", "Network Issue");
         return;
     }
     emitNewState(InternalCaseState::INIT_PARAM_UPLOAD);
@@ -1045,7 +1181,7 @@ void CWEcaseInstance::state_Running_jobList()
         computeIdleState();
         if (aJob.getState() == "FINISHED")
         {
-            cwe_globals::displayPopup("Job finished for current case", "Job Complete");
+            casePopup("Job finished for current case", "Job Complete");
         }
     }
 }
@@ -1057,7 +1193,7 @@ void CWEcaseInstance::state_StartingJob_jobInvoked(QString jobID)
     if (jobID.isEmpty())
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Unable to collect job ID. Please inform developers of this bug.", "ERROR");
+        casePopup("Unable to collect job ID. Please inform developers of this bug.", "ERROR");
         return;
     }
 
@@ -1075,13 +1211,13 @@ void CWEcaseInstance::state_StoppingJob_jobKilled()
     computeIdleState();
 }
 
-void CWEcaseInstance::state_WaitingFolderDel_taskDone(RequestState invokeStatus)
+void CWEcaseInstance::state_WaitingFolderDel_taskDone(bool opSucceeded)
 {
     if (myState != InternalCaseState::WAITING_FOLDER_DEL) return;
-    if (invokeStatus != RequestState::GOOD)
+    if (!opSucceeded)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Error: Unable to clean up canceled task. Please reset and try again.", "Remote Filesystem error");
+        casePopup("Error: Unable to clean up canceled task. Please reset and try again.", "Remote Filesystem error");
         return;
     }
 
@@ -1089,30 +1225,30 @@ void CWEcaseInstance::state_WaitingFolderDel_taskDone(RequestState invokeStatus)
     computeIdleState();
 }
 
-void CWEcaseInstance::state_Download_recursiveOpDone(RequestState invokeStatus)
+void CWEcaseInstance::state_Download_recursiveOpDone(bool opSucceeded)
 {
     if (myState != InternalCaseState::DOWNLOAD) return;
 
-    if (invokeStatus == RequestState::GOOD)
+    if (opSucceeded)
     {
-        cwe_globals::displayPopup("Case results successfully downloaded.", "Download Complete");
+        casePopup("Case results successfully downloaded.", "Download Complete");
     }
     else
     {
-        cwe_globals::displayPopup("Unable to download case, please check connection and try again.", "Download Error");
+        casePopup("Unable to download case, please check connection and try again.", "Download Error");
     }
 
     computeIdleState();
 }
 
-void CWEcaseInstance::state_Param_Save_taskDone(RequestState invokeStatus)
+void CWEcaseInstance::state_Param_Save_taskDone(bool opSucceeded)
 {
     if (myState != InternalCaseState::PARAM_SAVE) return;
 
-    if (invokeStatus != RequestState::GOOD)
+    if (!opSucceeded)
     {
         emitNewState(InternalCaseState::ERROR);
-        cwe_globals::displayPopup("Error: Unable to change parameters. Please reset and try again.", "Remote Filesystem error");
+        casePopup("Error: Unable to change parameters. Please reset and try again.", "Remote Filesystem error");
         return;
     }
 
@@ -1203,7 +1339,7 @@ void CWEcaseInstance::computeIdleState()
         return;
     }
 
-    if (cwe_globals::get_file_handle()->operationIsPending())
+    if (cwe_globals::get_file_op_scheduler()->pathIsBusy(caseFolder.getFullPath()))
     {
         emitNewState(InternalCaseState::EXTERN_FILE_OP);
         return;
@@ -1240,3 +1376,13 @@ void CWEcaseInstance::computeIdleState()
 
     emitNewState(InternalCaseState::READY);
 }
+
+void CWEcaseInstance::casePopup(QString message, QString header)
+{
+    if (errorPopups)
+    {
+        cwe_globals::displayPopup(message, header);
+        return;
+    }
+    qCDebug(agaveAppLayer, "%s: %s", qPrintable(header), qPrintable(message));
+}
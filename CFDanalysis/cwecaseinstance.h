@@ -41,6 +41,7 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QList>
+#include <QSet>
 #include <QThread>
 
 #include "remoteFiles/filenoderef.h"
@@ -93,7 +94,8 @@ public:
 
     //Of the following, only one enacted at a time
     //Return true if enacted, false if not
-    bool createCase(QString newName, const FileNodeRef &containingFolder);
+    bool createCase(QString newName, const FileNodeRef &containingFolder,
+                    QMap<QString, QString> initialParams = QMap<QString, QString>());
     bool duplicateCase(QString newName, const FileNodeRef &containingFolder, const FileNodeRef &oldCase);
     bool changeParameters(QMap<QString, QString> paramList);
     bool startStageApp(QString stageID);
@@ -101,6 +103,10 @@ public:
     bool stopJob();
     bool downloadCase(QString destLocalFile);
 
+    //Note: With popups off, errors are only logged. Sweeps use this, so many
+    //failing cases do not stack up popups.
+    void setErrorPopups(bool showPopups);
+
 signals:
     void haveNewState(CaseState newState);
     void underlyingFilesInterlockSignal();
@@ -109,8 +115,9 @@ private slots:
     void underlyingFilesInterlock(const FileNodeRef changedNode);
     void underlyingFilesUpdated();
     void jobListUpdated();
-    void fileTaskDone(RequestState invokeStatus);
+    void fileTaskDone(RequestState);
     void fileTaskStarted();
+    void scheduledOpDone(int opID, bool opSucceeded);
 
     void jobInvoked(RequestState invokeStatus, QJsonDocument jobData);
     void jobKilled(RequestState invokeStatus);
@@ -125,34 +132,54 @@ private:
 
     bool stageStatesEqual(QMap<QString, StageState> * list1, QMap<QString, StageState> * list2);
     bool updateStageStatesIfNew(QMap<QString, StageState> * newStageStates);
+    void markStagesChanged(const FileNodeRef changedNode);
+    StageState computeStageFileState(QString stageID);
     bool recomputeStageStates();
     void computeParamList();
+    void refreshParamCache(const QByteArray &paramBuffer);
 
     QByteArray produceJSONparams(QMap<QString, QString> paramList);
 
     void connectCaseSignals();
+    void watchCaseFolder();
 
     //The various state change functions:
-    void state_CopyingFolder_taskDone(RequestState invokeStatus);
+    void state_CopyingFolder_taskDone(bool opSucceeded);
     void state_DataLoad_fileChange_jobList();
     void state_ExternOp_taskDone();
-    void state_InitParam_taskDone(RequestState invokeStatus);
-    void state_MakingFolder_taskDone(RequestState invokeStatus);
+    void state_InitParam_taskDone(bool opSucceeded);
+    void state_MakingFolder_taskDone(bool opSucceeded);
     void state_Ready_fileChange_jobList();
     void state_Running_jobList();
     void state_StartingJob_jobInvoked(QString jobID);
     void state_StoppingJob_jobKilled();
-    void state_WaitingFolderDel_taskDone(RequestState invokeStatus);
-    void state_Download_recursiveOpDone(RequestState invokeStatus);
-    void state_Param_Save_taskDone(RequestState invokeStatus);
+    void state_WaitingFolderDel_taskDone(bool opSucceeded);
+    void state_Download_recursiveOpDone(bool opSucceeded);
+    void state_Param_Save_taskDone(bool opSucceeded);
 
     void computeIdleState();
+    void casePopup(QString message, QString header);
 
     bool defunct = false;
+    bool errorPopups = true;
     bool interlockHasFileChange = false;
     QMap<QString, StageState> storedStageStates;
+    QMap<QString, StageState> settledStageStates;
+
+    QMap<QString, StageState> stageFileStates;
+    QSet<QString> changedStages;
+    bool allStagesChanged = true;
+    bool stageInputsKnown = false;
+    CaseState lastCaseState = CaseState::LOADING;
+    InternalCaseState lastInternalState = InternalCaseState::ERROR;
+    QString lastRunningStage;
+    bool lastFolderLoaded = false;
+
     QMap<QString, QString> storedParamList;
     QMap<QString, QString> prospectiveNewParamList;
+    int paramSaveOpID = -1;
+    int caseOpID = -1;
+    QMap<QString, QString> initialParamList;
     QString runningID;
     QString runningStage;
     InternalCaseState myState = InternalCaseState::ERROR;
@@ -163,6 +190,12 @@ private:
     QString expectedNewCaseFolder;
     QString downloadDest;
 
+    QByteArray paramCacheBuffer;
+    bool paramCacheFilled = false;
+    bool paramCacheValid = false;
+    QString paramCacheTemplate;
+    QMap<QString, QString> paramCacheVars;
+
     QString caseParamFileName = ".caseParams";
     QString exitFileName = ".exit";
     bool triedParamFile = false;
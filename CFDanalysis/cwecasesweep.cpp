@@ -0,0 +1,297 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cwecasesweep.h"
+
+#include "cweanalysistype.h"
+#include "cwecaseinstance.h"
+
+#include "cwe_globals.h"
+
+CWEcaseSweep::CWEcaseSweep(CWEanalysisType * caseType, const FileNodeRef &containingFolder, QObject *parent) : QObject(parent)
+{
+    myType = caseType;
+    myFolder = containingFolder;
+
+    if (myType != nullptr)
+    {
+        QStringList stageList = myType->getStageIds();
+        if (!stageList.isEmpty())
+        {
+            firstStage = stageList.first();
+        }
+    }
+}
+
+CWEcaseSweep::~CWEcaseSweep()
+{
+    for (CWEcaseInstance * aCase : activeCases)
+    {
+        aCase->deleteLater();
+    }
+}
+
+QList<QMap<QString, QString>> CWEcaseSweep::expandGrid(QMap<QString, QStringList> paramGrid)
+{
+    //Every combination of the listed values, with the last parameter varying fastest
+    QList<QMap<QString, QString>> ret;
+    ret.append(QMap<QString, QString>());
+
+    for (auto itr = paramGrid.cbegin(); itr != paramGrid.cend(); itr++)
+    {
+        if ((*itr).isEmpty()) continue;
+
+        QList<QMap<QString, QString>> expanded;
+        for (const QMap<QString, QString> &aPartial : ret)
+        {
+            for (QString aValue : *itr)
+            {
+                QMap<QString, QString> newEntry = aPartial;
+                newEntry.insert(itr.key(), aValue);
+                expanded.append(newEntry);
+            }
+        }
+        ret = expanded;
+    }
+
+    return ret;
+}
+
+void CWEcaseSweep::addCase(QString caseName, QMap<QString, QString> params)
+{
+    if (running) return;
+
+    SWEEP_CASE newCase;
+    newCase.caseName = caseName;
+    newCase.params = params;
+    caseList.append(newCase);
+}
+
+void CWEcaseSweep::setSubmitFirstStage(bool newSetting)
+{
+    if (running) return;
+    submitFirstStage = newSetting;
+}
+
+void CWEcaseSweep::setMaxConcurrent(int newLimit)
+{
+    if (newLimit < 1) newLimit = 1;
+    maxConcurrent = newLimit;
+}
+
+bool CWEcaseSweep::start()
+{
+    if (running) return false;
+    if (myType == nullptr) return false;
+    if (myFolder.isNil()) return false;
+    if (caseList.isEmpty()) return false;
+    if (submitFirstStage && firstStage.isEmpty()) return false;
+
+    running = true;
+    canceled = false;
+    sweepTimer.start();
+    advance();
+    return true;
+}
+
+void CWEcaseSweep::cancel()
+{
+    //Cases already started are left to finish
+    canceled = true;
+    for (int i = 0; i < caseList.size(); i++)
+    {
+        if (caseList.at(i).step != SweepCaseStep::WAITING) continue;
+        finishCase(i, SweepCaseStep::FAILED, "Sweep canceled before this case was started.");
+    }
+    advance();
+}
+
+bool CWEcaseSweep::isRunning()
+{
+    return running;
+}
+
+QList<SWEEP_CASE> CWEcaseSweep::getCases()
+{
+    return caseList;
+}
+
+int CWEcaseSweep::countInStep(SweepCaseStep theStep)
+{
+    int ret = 0;
+    for (const SWEEP_CASE &aCase : caseList)
+    {
+        if (aCase.step == theStep) ret++;
+    }
+    return ret;
+}
+
+double CWEcaseSweep::getCasesPerMinute()
+{
+    if (!sweepTimer.isValid()) return 0.0;
+    qint64 msecTaken = sweepTimer.elapsed();
+    if (msecTaken <= 0) return 0.0;
+
+    return countInStep(SweepCaseStep::DONE) * 60000.0 / msecTaken;
+}
+
+void CWEcaseSweep::advance()
+{
+    if (!running) return;
+
+    for (int caseIndex : activeCases.keys())
+    {
+        checkActiveCase(caseIndex);
+    }
+
+    for (int i = 0; (i < caseList.size()) && !canceled; i++)
+    {
+        if (activeCases.size() >= maxConcurrent) break;
+        if (caseList.at(i).step != SweepCaseStep::WAITING) continue;
+
+        startNextCase(i);
+    }
+
+    if (!activeCases.isEmpty()) return;
+    if (countInStep(SweepCaseStep::WAITING) > 0) return;
+
+    running = false;
+    emit sweepFinished();
+}
+
+void CWEcaseSweep::checkActiveCase(int caseIndex)
+{
+    CWEcaseInstance * theCase = activeCases.value(caseIndex, nullptr);
+    if (theCase == nullptr) return;
+
+    CaseState newState = theCase->getCaseState();
+
+    if ((newState == CaseState::ERROR) || (newState == CaseState::DEFUNCT) ||
+            (newState == CaseState::INVALID) || (newState == CaseState::READY_ERROR))
+    {
+        if (caseList.at(caseIndex).step == SweepCaseStep::SUBMITTING)
+        {
+            finishCase(caseIndex, SweepCaseStep::FAILED, "Unable to start the first stage.");
+        }
+        else
+        {
+            finishCase(caseIndex, SweepCaseStep::FAILED, "Unable to create the case folder and parameters.");
+        }
+        return;
+    }
+
+    if (caseList.at(caseIndex).step == SweepCaseStep::SUBMITTING)
+    {
+        if (newState == CaseState::RUNNING)
+        {
+            finishCase(caseIndex, SweepCaseStep::DONE, "Case created and first stage started.");
+        }
+        else if ((newState == CaseState::READY) &&
+                 (theCase->getStageStates().value(firstStage, StageState::UNRUN) != StageState::RUNNING))
+        {
+            finishCase(caseIndex, SweepCaseStep::FAILED, "The first stage job was not accepted.");
+        }
+        return;
+    }
+
+    if (newState != CaseState::READY) return;
+
+    if (!submitFirstStage)
+    {
+        finishCase(caseIndex, SweepCaseStep::DONE, "Case created.");
+        return;
+    }
+
+    StageState firstStageState = theCase->getStageStates().value(firstStage, StageState::LOADING);
+    if (firstStageState == StageState::LOADING) return;
+
+    if ((firstStageState != StageState::UNRUN) || !theCase->startStageApp(firstStage))
+    {
+        finishCase(caseIndex, SweepCaseStep::FAILED, "Case created, but unable to start the first stage.");
+        return;
+    }
+
+    caseList[caseIndex].step = SweepCaseStep::SUBMITTING;
+}
+
+void CWEcaseSweep::finishCase(int caseIndex, SweepCaseStep endStep, QString message)
+{
+    SWEEP_CASE &theEntry = caseList[caseIndex];
+    theEntry.step = endStep;
+    theEntry.message = message;
+
+    if (caseTimers.contains(caseIndex))
+    {
+        theEntry.msecTaken = caseTimers.take(caseIndex).elapsed();
+    }
+
+    if (activeCases.contains(caseIndex))
+    {
+        CWEcaseInstance * theCase = activeCases.take(caseIndex);
+        QObject::disconnect(theCase, nullptr, this, nullptr);
+        theCase->deleteLater();
+    }
+
+    emit caseFinished(caseIndex);
+}
+
+void CWEcaseSweep::startNextCase(int caseIndex)
+{
+    SWEEP_CASE &theEntry = caseList[caseIndex];
+
+    if (!cwe_globals::isValidFolderName(theEntry.caseName))
+    {
+        finishCase(caseIndex, SweepCaseStep::FAILED, "Invalid case folder name.");
+        return;
+    }
+
+    //Each case's folder and parameter file are queued file operations, finished
+    //by their own op IDs, so cases in progress do not take each other's results
+    CWEcaseInstance * newCase = new CWEcaseInstance(myType);
+    newCase->setErrorPopups(false);
+    if (!newCase->createCase(theEntry.caseName, myFolder, theEntry.params))
+    {
+        newCase->deleteLater();
+        finishCase(caseIndex, SweepCaseStep::FAILED, "Unable to queue creation of the case folder.");
+        return;
+    }
+
+    QObject::connect(newCase, SIGNAL(haveNewState(CaseState)),
+                     this, SLOT(advance()),
+                     Qt::QueuedConnection);
+
+    theEntry.step = SweepCaseStep::CREATING;
+    activeCases.insert(caseIndex, newCase);
+    caseTimers[caseIndex].start();
+}
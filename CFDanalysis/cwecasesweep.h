@@ -0,0 +1,114 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CWECASESWEEP_H
+#define CWECASESWEEP_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QStringList>
+#include <QElapsedTimer>
+
+#include "remoteFiles/filenoderef.h"
+
+class CWEanalysisType;
+class CWEcaseInstance;
+
+//Note: A sweep makes many cases of one type, one per set of parameters.
+//Each case folder is made with its parameters already in place, and the
+//first stage may then be started. Up to maxConcurrent cases are in progress
+//at once, so that one case's job submission and data reload overlap with
+//the next case's folder creation.
+
+#define CWE_SWEEP_DEFAULT_CONCURRENT 4
+
+enum class SweepCaseStep {WAITING, CREATING, SUBMITTING, DONE, FAILED};
+
+struct SWEEP_CASE {
+    QString caseName;
+    QMap<QString, QString> params;
+    SweepCaseStep step = SweepCaseStep::WAITING;
+    QString message;
+    qint64 msecTaken = -1;
+};
+
+class CWEcaseSweep : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CWEcaseSweep(CWEanalysisType * caseType, const FileNodeRef &containingFolder, QObject *parent = nullptr);
+    ~CWEcaseSweep();
+
+    static QList<QMap<QString, QString>> expandGrid(QMap<QString, QStringList> paramGrid);
+
+    void addCase(QString caseName, QMap<QString, QString> params);
+    void setSubmitFirstStage(bool newSetting);
+    void setMaxConcurrent(int newLimit);
+
+    bool start();
+    void cancel();
+    bool isRunning();
+
+    QList<SWEEP_CASE> getCases();
+    int countInStep(SweepCaseStep theStep);
+    double getCasesPerMinute();
+
+signals:
+    void caseFinished(int caseIndex);
+    void sweepFinished();
+
+private slots:
+    void advance();
+
+private:
+    void checkActiveCase(int caseIndex);
+    void finishCase(int caseIndex, SweepCaseStep endStep, QString message);
+    void startNextCase(int caseIndex);
+
+    CWEanalysisType * myType;
+    FileNodeRef myFolder;
+    QString firstStage;
+    bool submitFirstStage = false;
+    int maxConcurrent = CWE_SWEEP_DEFAULT_CONCURRENT;
+    bool running = false;
+    bool canceled = false;
+
+    QList<SWEEP_CASE> caseList;
+    QMap<int, CWEcaseInstance *> activeCases;
+    QMap<int, QElapsedTimer> caseTimers;
+    QElapsedTimer sweepTimer;
+};
+
+#endif // CWECASESWEEP_H
@@ -0,0 +1,367 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cwefilechangedispatcher.h"
+
+#include "remoteFiles/fileoperator.h"
+#include "cwe_globals.h"
+
+#include <QTimer>
+#include <QSet>
+
+CWEfileChangeDispatcher::CWEfileChangeDispatcher(QObject *parent) : QObject(parent)
+{
+    QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileSystemChange(FileNodeRef)),
+                     this, SLOT(fileChanged(FileNodeRef)));
+}
+
+CWEfileChangeDispatcher::~CWEfileChangeDispatcher()
+{
+    for (PathTrieNode * aChild : rootNode.children)
+    {
+        deleteSubtree(aChild);
+    }
+}
+
+bool CWEfileChangeDispatcher::subscribe(QString pathPrefix, QObject * receiver, const char * member)
+{
+    int methodIndex = findSlot(receiver, member);
+    if (methodIndex < 0) return false;
+
+    if (receiverPaths.contains(receiver) && receiverPaths[receiver].contains(methodIndex))
+    {
+        for (QString oldPath : receiverPaths[receiver].take(methodIndex))
+        {
+            removeSubscription(receiver, methodIndex, oldPath);
+        }
+    }
+
+    addSubscription(receiver, methodIndex, pathPrefix);
+    return true;
+}
+
+bool CWEfileChangeDispatcher::watchPath(QString aPath, QObject * receiver, const char * member)
+{
+    int methodIndex = findSlot(receiver, member);
+    if (methodIndex < 0) return false;
+
+    if (receiverPaths.value(receiver).value(methodIndex).contains(aPath)) return true;
+
+    addSubscription(receiver, methodIndex, aPath);
+    return true;
+}
+
+void CWEfileChangeDispatcher::unwatchPath(QString aPath, QObject * receiver, const char * member)
+{
+    if (!receiverPaths.contains(receiver)) return;
+
+    int methodIndex = findSlot(receiver, member);
+    if (methodIndex < 0) return;
+    if (!receiverPaths[receiver].contains(methodIndex)) return;
+    if (receiverPaths[receiver][methodIndex].removeAll(aPath) == 0) return;
+
+    removeSubscription(receiver, methodIndex, aPath);
+
+    if (receiverPaths[receiver][methodIndex].isEmpty())
+    {
+        receiverPaths[receiver].remove(methodIndex);
+    }
+    if (receiverPaths[receiver].isEmpty())
+    {
+        unsubscribe(receiver);
+    }
+}
+
+void CWEfileChangeDispatcher::unsubscribe(QObject * receiver)
+{
+    if (!receiverPaths.contains(receiver)) return;
+
+    QMap<int, QStringList> oldPaths = receiverPaths.take(receiver);
+    for (auto itr = oldPaths.cbegin(); itr != oldPaths.cend(); itr++)
+    {
+        for (QString oldPath : itr.value())
+        {
+            removeSubscription(receiver, itr.key(), oldPath);
+        }
+    }
+    QObject::disconnect(receiver, SIGNAL(destroyed(QObject*)),
+                        this, SLOT(receiverDestroyed(QObject*)));
+}
+
+void CWEfileChangeDispatcher::fileChanged(FileNodeRef changedFile)
+{
+    QString changedPath;
+    if (!changedFile.isNil())
+    {
+        changedPath = changedFile.getFullPath();
+    }
+
+    //By the next pass the node will usually have left the DELETING state
+    if (!changedFile.isNil() && (changedFile.getNodeState() == NodeState::DELETING))
+    {
+        pendingOrder.removeAll(changedPath);
+        pendingChanges.remove(changedPath);
+
+        QHash<QString, FileNodeRef> deletedNode;
+        deletedNode[changedPath] = changedFile;
+        deliverChanges({changedPath}, deletedNode);
+        return;
+    }
+
+    if (!pendingChanges.contains(changedPath))
+    {
+        pendingOrder.append(changedPath);
+        pendingChanges[changedPath] = changedFile;
+    }
+
+    if (flushQueued) return;
+    flushQueued = true;
+    QTimer::singleShot(0, this, SLOT(flushChanges()));
+}
+
+void CWEfileChangeDispatcher::flushChanges()
+{
+    flushQueued = false;
+
+    QList<QString> changedPaths = pendingOrder;
+    QHash<QString, FileNodeRef> changedNodes = pendingChanges;
+    pendingOrder.clear();
+    pendingChanges.clear();
+
+    deliverChanges(changedPaths, changedNodes);
+}
+
+void CWEfileChangeDispatcher::receiverDestroyed(QObject * receiver)
+{
+    if (!receiverPaths.contains(receiver)) return;
+
+    QMap<int, QStringList> oldPaths = receiverPaths.take(receiver);
+    for (auto itr = oldPaths.cbegin(); itr != oldPaths.cend(); itr++)
+    {
+        for (QString oldPath : itr.value())
+        {
+            removeSubscription(receiver, itr.key(), oldPath);
+        }
+    }
+}
+
+void CWEfileChangeDispatcher::deliverChanges(QList<QString> changedPaths, QHash<QString, FileNodeRef> changedNodes)
+{
+    //Gather every call first, since a slot may subscribe or unsubscribe
+    typedef QPair<QObject *, int> DeliveryKey;
+    QList<DeliveryKey> deliveryOrder;
+    QHash<DeliveryKey, FileSubscription> deliveryTargets;
+    QHash<DeliveryKey, QList<FileNodeRef>> deliveryNodes;
+
+    for (QString aPath : changedPaths)
+    {
+        QList<FileSubscription> matches;
+        collectSubscriptions(aPath, &matches);
+
+        //A member watching several paths around this one still gets the file once
+        QSet<DeliveryKey> pathKeys;
+        for (const FileSubscription &aMatch : matches)
+        {
+            DeliveryKey aKey(aMatch.receiver.data(), aMatch.method.methodIndex());
+            if (pathKeys.contains(aKey)) continue;
+            pathKeys.insert(aKey);
+
+            if (!deliveryTargets.contains(aKey))
+            {
+                deliveryOrder.append(aKey);
+                deliveryTargets[aKey] = aMatch;
+            }
+            deliveryNodes[aKey].append(changedNodes.value(aPath));
+        }
+    }
+
+    for (const DeliveryKey &aKey : deliveryOrder)
+    {
+        FileSubscription theTarget = deliveryTargets.value(aKey);
+
+        if (theTarget.method.parameterCount() == 0)
+        {
+            if (theTarget.receiver.isNull()) continue;
+            theTarget.method.invoke(theTarget.receiver.data(), Qt::DirectConnection);
+            continue;
+        }
+
+        for (FileNodeRef aNode : deliveryNodes.value(aKey))
+        {
+            if (theTarget.receiver.isNull()) break;
+            theTarget.method.invoke(theTarget.receiver.data(), Qt::DirectConnection,
+                                    Q_ARG(FileNodeRef, aNode));
+        }
+    }
+}
+
+QStringList CWEfileChangeDispatcher::splitPath(QString aPath)
+{
+    return aPath.split('/', QString::SkipEmptyParts);
+}
+
+int CWEfileChangeDispatcher::findSlot(QObject * receiver, const char * member)
+{
+    if ((receiver == nullptr) || (member == nullptr) || (member[0] == '\0')) return -1;
+
+    //SLOT() puts a code digit before the signature
+    QByteArray signature = QMetaObject::normalizedSignature(member + 1);
+    int methodIndex = receiver->metaObject()->indexOfMethod(signature.constData());
+    if (methodIndex < 0)
+    {
+        qCDebug(agaveAppLayer, "ERROR: File change subscription to unknown slot: %s", signature.constData());
+        return -1;
+    }
+
+    QMetaMethod theMethod = receiver->metaObject()->method(methodIndex);
+    if ((theMethod.parameterCount() > 1) ||
+            ((theMethod.parameterCount() == 1) && (theMethod.parameterTypes().first() != "FileNodeRef")))
+    {
+        qCDebug(agaveAppLayer, "ERROR: File change subscription to slot with wrong arguments: %s", signature.constData());
+        return -1;
+    }
+
+    return methodIndex;
+}
+
+void CWEfileChangeDispatcher::addSubscription(QObject * receiver, int methodIndex, QString aPath)
+{
+    if (!receiverPaths.contains(receiver))
+    {
+        QObject::connect(receiver, SIGNAL(destroyed(QObject*)),
+                         this, SLOT(receiverDestroyed(QObject*)));
+    }
+    receiverPaths[receiver][methodIndex].append(aPath);
+
+    FileSubscription newSubscription;
+    newSubscription.receiver = receiver;
+    newSubscription.method = receiver->metaObject()->method(methodIndex);
+    findNode(aPath, true)->subscriptions.append(newSubscription);
+}
+
+CWEfileChangeDispatcher::PathTrieNode * CWEfileChangeDispatcher::findNode(QString aPath, bool createMissing)
+{
+    PathTrieNode * aNode = &rootNode;
+
+    for (QString aPart : splitPath(aPath))
+    {
+        PathTrieNode * nextNode = aNode->children.value(aPart, nullptr);
+        if (nextNode == nullptr)
+        {
+            if (!createMissing) return nullptr;
+            nextNode = new PathTrieNode();
+            aNode->children.insert(aPart, nextNode);
+        }
+        aNode = nextNode;
+    }
+
+    return aNode;
+}
+
+void CWEfileChangeDispatcher::removeSubscription(QObject * receiver, int methodIndex, QString aPath)
+{
+    //The nodes along the path are kept so that empty ones can be pruned after
+    QList<PathTrieNode *> nodePath;
+    QStringList pathParts = splitPath(aPath);
+
+    PathTrieNode * aNode = &rootNode;
+    nodePath.append(aNode);
+    for (QString aPart : pathParts)
+    {
+        aNode = aNode->children.value(aPart, nullptr);
+        if (aNode == nullptr) return;
+        nodePath.append(aNode);
+    }
+
+    for (auto itr = aNode->subscriptions.begin(); itr != aNode->subscriptions.end();)
+    {
+        //The receiver may be part way through destruction, so it is matched by address
+        if (((*itr).receiver.data() == receiver || (*itr).receiver.isNull()) &&
+                ((*itr).method.methodIndex() == methodIndex))
+        {
+            itr = aNode->subscriptions.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+
+    for (int i = pathParts.size(); i > 0; i--)
+    {
+        PathTrieNode * checkNode = nodePath.at(i);
+        if (!checkNode->subscriptions.isEmpty() || !checkNode->children.isEmpty()) return;
+
+        nodePath.at(i - 1)->children.remove(pathParts.at(i - 1));
+        delete checkNode;
+    }
+}
+
+void CWEfileChangeDispatcher::collectSubscriptions(QString changedPath, QList<FileSubscription> * output)
+{
+    //Subscribers at or above the changed path
+    PathTrieNode * aNode = &rootNode;
+    output->append(aNode->subscriptions);
+
+    for (QString aPart : splitPath(changedPath))
+    {
+        aNode = aNode->children.value(aPart, nullptr);
+        if (aNode == nullptr) return;
+        output->append(aNode->subscriptions);
+    }
+
+    //Subscribers below the changed path, since a folder change can touch all of its contents
+    for (PathTrieNode * aChild : aNode->children)
+    {
+        collectSubtree(aChild, output);
+    }
+}
+
+void CWEfileChangeDispatcher::collectSubtree(PathTrieNode * aNode, QList<FileSubscription> * output)
+{
+    output->append(aNode->subscriptions);
+    for (PathTrieNode * aChild : aNode->children)
+    {
+        collectSubtree(aChild, output);
+    }
+}
+
+void CWEfileChangeDispatcher::deleteSubtree(PathTrieNode * aNode)
+{
+    for (PathTrieNode * aChild : aNode->children)
+    {
+        deleteSubtree(aChild);
+    }
+    delete aNode;
+}
@@ -0,0 +1,110 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CWEFILECHANGEDISPATCHER_H
+#define CWEFILECHANGEDISPATCHER_H
+
+#include <QObject>
+#include <QMap>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QPointer>
+#include <QMetaMethod>
+
+#include "remoteFiles/filenoderef.h"
+
+//Note: This stands between the file operator's fileSystemChange signal and
+//the many objects which watch part of the file tree. Each subscriber gives
+//a path and a slot. A change is passed to subscribers at that path, above it,
+//or below it, and to no one else. Changes are gathered and delivered once per
+//pass of the event loop, so a burst of changes to the same file is one call.
+//A slot taking a FileNodeRef gets one call per changed file. A slot taking
+//nothing gets one call per pass, however many files changed.
+//A file being deleted is the exception: it is passed on at once, so that
+//subscribers still see it in the DELETING state.
+
+class CWEfileChangeDispatcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CWEfileChangeDispatcher(QObject *parent = nullptr);
+    ~CWEfileChangeDispatcher();
+
+    bool subscribe(QString pathPrefix, QObject * receiver, const char * member);
+    //Note: member is given with SLOT(). Subscribing again with the same member
+    //moves the subscription to the new path. An empty path watches everything.
+    bool watchPath(QString aPath, QObject * receiver, const char * member);
+    void unwatchPath(QString aPath, QObject * receiver, const char * member);
+    //Note: watchPath adds a path to those already watched by the member,
+    //for subscribers which follow a changing set of folders.
+    void unsubscribe(QObject * receiver);
+
+private slots:
+    void fileChanged(FileNodeRef changedFile);
+    void flushChanges();
+    void receiverDestroyed(QObject * receiver);
+
+private:
+    struct FileSubscription
+    {
+        QPointer<QObject> receiver;
+        QMetaMethod method;
+    };
+
+    struct PathTrieNode
+    {
+        QMap<QString, PathTrieNode *> children;
+        QList<FileSubscription> subscriptions;
+    };
+
+    static QStringList splitPath(QString aPath);
+    static int findSlot(QObject * receiver, const char * member);
+    void addSubscription(QObject * receiver, int methodIndex, QString aPath);
+    void deliverChanges(QList<QString> changedPaths, QHash<QString, FileNodeRef> changedNodes);
+    PathTrieNode * findNode(QString aPath, bool createMissing);
+    void removeSubscription(QObject * receiver, int methodIndex, QString aPath);
+    void collectSubscriptions(QString changedPath, QList<FileSubscription> * output);
+    static void collectSubtree(PathTrieNode * aNode, QList<FileSubscription> * output);
+    static void deleteSubtree(PathTrieNode * aNode);
+
+    PathTrieNode rootNode;
+    QMap<QObject *, QMap<int, QStringList>> receiverPaths;
+
+    QList<QString> pendingOrder;
+    QHash<QString, FileNodeRef> pendingChanges;
+    bool flushQueued = false;
+};
+
+#endif // CWEFILECHANGEDISPATCHER_H
@@ -0,0 +1,621 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cwefileopscheduler.h"
+
+#include "cwe_globals.h"
+#include "remotedatainterface.h"
+#include "filemetadata.h"
+
+#include "remoteFiles/filetreenode.h"
+#include "remoteFiles/fileoperator.h"
+#include "remoteFiles/filerecursiveoperator.h"
+
+#include <QFileInfo>
+#include <QDir>
+
+CWEfileOpScheduler::CWEfileOpScheduler(QObject *parent) : QObject(parent)
+{
+    queueModel = new QStandardItemModel(this);
+    queueModel->setHorizontalHeaderLabels({"Operation", "Remote Path", "Status"});
+
+    //Note: This must be a direct connection. A queued one could arrive after
+    //the next operator request has been started, and finish the wrong one.
+    QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileOpDone(RequestState,QString)),
+                     this, SLOT(fileOpDone(RequestState,QString)),
+                     Qt::DirectConnection);
+    QObject::connect(&progressTimer, SIGNAL(timeout()),
+                     this, SLOT(refreshProgress()));
+    progressTimer.setInterval(1000);
+}
+
+int CWEfileOpScheduler::queueCopy(const FileNodeRef &targetNode, QString newPath)
+{
+    if (targetNode.isNil()) return -1;
+    if (newPath.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::COPY;
+    newOp.targetNode = targetNode;
+    newOp.argument = newPath;
+    newOp.remotePaths << targetNode.getFullPath() << siblingPath(targetNode.getFullPath(), newPath);
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueMove(const FileNodeRef &targetNode, QString newPath)
+{
+    if (targetNode.isNil()) return -1;
+    if (targetNode.isRootNode()) return -1;
+    if (newPath.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::MOVE;
+    newOp.targetNode = targetNode;
+    newOp.argument = newPath;
+    newOp.remotePaths << targetNode.getFullPath() << siblingPath(targetNode.getFullPath(), newPath);
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueRename(const FileNodeRef &targetNode, QString newName)
+{
+    if (targetNode.isNil()) return -1;
+    if (targetNode.isRootNode()) return -1;
+    if (newName.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::RENAME;
+    newOp.targetNode = targetNode;
+    newOp.argument = newName;
+    newOp.remotePaths << targetNode.getFullPath() << siblingPath(targetNode.getFullPath(), newName);
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueDelete(const FileNodeRef &targetNode)
+{
+    if (targetNode.isNil()) return -1;
+    if (targetNode.isRootNode()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::REMOVE;
+    newOp.targetNode = targetNode;
+    newOp.remotePaths << targetNode.getFullPath();
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueCreateFolder(const FileNodeRef &parentFolder, QString folderName)
+{
+    if (parentFolder.isNil()) return -1;
+    if (parentFolder.getFileType() != FileType::DIR) return -1;
+    if (folderName.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::MAKE_FOLDER;
+    newOp.targetNode = parentFolder;
+    newOp.argument = folderName;
+    newOp.remotePaths << childPath(parentFolder.getFullPath(), folderName);
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueUpload(const FileNodeRef &destFolder, QString localFile)
+{
+    if (destFolder.isNil()) return -1;
+    if (destFolder.getFileType() != FileType::DIR) return -1;
+
+    QFileInfo localInfo(localFile);
+    if (!localInfo.isFile()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::UPLOAD;
+    newOp.targetNode = destFolder;
+    newOp.argument = localInfo.absoluteFilePath();
+    newOp.remotePaths << childPath(destFolder.getFullPath(), localInfo.fileName());
+    newOp.localPaths << QDir::cleanPath(localInfo.absoluteFilePath());
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueBufferUpload(const FileNodeRef &destFolder, QByteArray fileData, QString fileName)
+{
+    if (destFolder.isNil()) return -1;
+    if (destFolder.getFileType() != FileType::DIR) return -1;
+    if (fileName.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::UPLOAD_BUFFER;
+    newOp.targetNode = destFolder;
+    newOp.argument = fileName;
+    newOp.fileData = fileData;
+    newOp.remotePaths << childPath(destFolder.getFullPath(), fileName);
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueDownload(const FileNodeRef &targetNode, QString localFile)
+{
+    if (targetNode.isNil()) return -1;
+    if (targetNode.getFileType() != FileType::FILE) return -1;
+    if (localFile.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::DOWNLOAD;
+    newOp.targetNode = targetNode;
+    newOp.argument = localFile;
+    newOp.remotePaths << targetNode.getFullPath();
+    newOp.localPaths << QDir::cleanPath(QFileInfo(localFile).absoluteFilePath());
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueFolderUpload(const FileNodeRef &destFolder, QString localFolder)
+{
+    if (destFolder.isNil()) return -1;
+    if (destFolder.getFileType() != FileType::DIR) return -1;
+
+    QFileInfo localInfo(localFolder);
+    if (!localInfo.isDir()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::UPLOAD_FOLDER;
+    newOp.targetNode = destFolder;
+    newOp.argument = localInfo.absoluteFilePath();
+    newOp.remotePaths << childPath(destFolder.getFullPath(), localInfo.fileName());
+    newOp.localPaths << QDir::cleanPath(localInfo.absoluteFilePath());
+    return addOp(newOp);
+}
+
+int CWEfileOpScheduler::queueFolderDownload(const FileNodeRef &targetFolder, QString localFolder)
+{
+    if (targetFolder.isNil()) return -1;
+    if (targetFolder.getFileType() != FileType::DIR) return -1;
+    if (localFolder.isEmpty()) return -1;
+
+    FileOp newOp;
+    newOp.type = FileOpType::DOWNLOAD_FOLDER;
+    newOp.targetNode = targetFolder;
+    newOp.argument = localFolder;
+    newOp.remotePaths << targetFolder.getFullPath();
+    newOp.localPaths << QDir::cleanPath(QFileInfo(localFolder).absoluteFilePath());
+    return addOp(newOp);
+}
+
+bool CWEfileOpScheduler::cancelOp(int opID)
+{
+    for (int i = 0; i < opQueue.size(); i++)
+    {
+        if (opQueue.at(i).opID != opID) continue;
+        //Once started, an operation cannot be called back
+        if (opQueue.at(i).state != FileOpState::QUEUED) return false;
+
+        finishOp(i, false, "File operation cancelled.");
+        scheduleStart();
+        return true;
+    }
+    return false;
+}
+
+bool CWEfileOpScheduler::opIsPending(int opID)
+{
+    for (const FileOp &anOp : opQueue)
+    {
+        if (anOp.opID == opID) return true;
+    }
+    return false;
+}
+
+bool CWEfileOpScheduler::pathIsBusy(QString remotePath)
+{
+    for (const FileOp &anOp : opQueue)
+    {
+        if (anOp.state != FileOpState::RUNNING) continue;
+
+        for (const QString &aPath : anOp.remotePaths)
+        {
+            if (pathsOverlap(aPath, remotePath)) return true;
+        }
+    }
+    return false;
+}
+
+int CWEfileOpScheduler::pendingOpCount()
+{
+    return opQueue.size();
+}
+
+QStandardItemModel * CWEfileOpScheduler::getQueueModel()
+{
+    return queueModel;
+}
+
+void CWEfileOpScheduler::fileOpDone(RequestState opState, QString message)
+{
+    //The file operator runs one request at a time, and only one of ours is
+    //ever given to it, so that one is the one done
+    for (int i = 0; i < opQueue.size(); i++)
+    {
+        if (opQueue.at(i).state != FileOpState::RUNNING) continue;
+        if (!opQueue.at(i).viaOperator) continue;
+
+        finishOp(i, (opState == RequestState::GOOD), message);
+        break;
+    }
+
+    scheduleStart();
+}
+
+void CWEfileOpScheduler::opReplied(RequestState opState)
+{
+    RemoteDataReply * theReply = qobject_cast<RemoteDataReply *>(QObject::sender());
+    if (!replyOps.contains(theReply)) return;
+    int opID = replyOps.take(theReply);
+
+    for (int i = 0; i < opQueue.size(); i++)
+    {
+        if (opQueue.at(i).opID != opID) continue;
+
+        bool opSucceeded = (opState == RequestState::GOOD);
+        if (opSucceeded)
+        {
+            refreshAfterOp(opQueue.at(i));
+        }
+        finishOp(i, opSucceeded, opSucceeded ? QString("File operation complete.") :
+                                               QString("File operation failed. Please try again."));
+        break;
+    }
+
+    scheduleStart();
+}
+
+void CWEfileOpScheduler::startOps()
+{
+    startQueued = false;
+
+    //An operator request started outside the queue has no recorded paths and
+    //could be touching anything, so nothing new starts until it is done.
+    //Its fileOpDone starts the queue again.
+    if (!operatorOpRunning && cwe_globals::get_file_handle()->operationIsPending())
+    {
+        refreshProgress();
+        return;
+    }
+
+    for (int i = 0; i < opQueue.size(); i++)
+    {
+        if (runningCount >= CWE_FILE_OP_MAX_CONCURRENT) break;
+        if (opQueue.at(i).state != FileOpState::QUEUED) continue;
+
+        bool isBlocked = false;
+        for (int j = 0; (j < i) && !isBlocked; j++)
+        {
+            isBlocked = opsOverlap(opQueue.at(j), opQueue.at(i));
+        }
+        if (isBlocked) continue;
+
+        //The file operator takes a new request only when it is idle
+        if (opNeedsOperator(opQueue.at(i).type) && operatorOpRunning)
+        {
+            continue;
+        }
+
+        if (!sendOp(&opQueue[i]))
+        {
+            finishOp(i, false, "Unable to start file operation. Please try again.");
+            scheduleStart();
+            return;
+        }
+
+        emit opStarted(opQueue.at(i).opID);
+    }
+
+    refreshProgress();
+}
+
+void CWEfileOpScheduler::refreshProgress()
+{
+    for (int i = 0; i < opQueue.size(); i++)
+    {
+        updateRow(i);
+    }
+
+    if (runningCount > 0)
+    {
+        if (!progressTimer.isActive()) progressTimer.start();
+    }
+    else
+    {
+        progressTimer.stop();
+    }
+}
+
+int CWEfileOpScheduler::addOp(FileOp newOp)
+{
+    newOp.opID = nextOpID;
+    nextOpID++;
+    newOp.state = FileOpState::QUEUED;
+    opQueue.append(newOp);
+
+    QList<QStandardItem *> newRow;
+    newRow << new QStandardItem(opDescription(newOp.type));
+    newRow << new QStandardItem(newOp.remotePaths.first());
+    newRow << new QStandardItem("Queued");
+    queueModel->appendRow(newRow);
+
+    emit queueChanged();
+
+    //Starting is put off so the caller has the ID before anything is signaled
+    scheduleStart();
+    return newOp.opID;
+}
+
+bool CWEfileOpScheduler::sendOp(FileOp * anOp)
+{
+    if (anOp->targetNode.isNil()) return false;
+
+    if (opNeedsOperator(anOp->type))
+    {
+        if (!sendOpToOperator(anOp)) return false;
+        anOp->viaOperator = true;
+        operatorOpRunning = true;
+    }
+    else
+    {
+        RemoteDataReply * theReply = sendOpToConnection(anOp);
+        if (theReply == nullptr) return false;
+
+        replyOps.insert(theReply, anOp->opID);
+        //Each reply signal carries more, but only the outcome is needed here
+        QObject::connect(theReply, SIGNAL(haveCopyReply(RequestState,FileMetaData)),
+                         this, SLOT(opReplied(RequestState)));
+        QObject::connect(theReply, SIGNAL(haveMoveReply(RequestState,FileMetaData)),
+                         this, SLOT(opReplied(RequestState)));
+        QObject::connect(theReply, SIGNAL(haveRenameReply(RequestState,FileMetaData)),
+                         this, SLOT(opReplied(RequestState)));
+        QObject::connect(theReply, SIGNAL(haveMkdirReply(RequestState,FileMetaData)),
+                         this, SLOT(opReplied(RequestState)));
+        QObject::connect(theReply, SIGNAL(haveUploadReply(RequestState,FileMetaData)),
+                         this, SLOT(opReplied(RequestState)));
+        QObject::connect(theReply, SIGNAL(haveDownloadReply(RequestState)),
+                         this, SLOT(opReplied(RequestState)));
+    }
+
+    anOp->state = FileOpState::RUNNING;
+    anOp->fileData.clear();
+    anOp->runTime.start();
+    runningCount++;
+    return true;
+}
+
+bool CWEfileOpScheduler::sendOpToOperator(FileOp * anOp)
+{
+    FileOperator * theOperator = cwe_globals::get_file_handle();
+
+    switch (anOp->type)
+    {
+    case FileOpType::REMOVE:
+        theOperator->sendDeleteReq(anOp->targetNode); break;
+    case FileOpType::UPLOAD_FOLDER:
+        theOperator->getRecursiveOp()->enactRecursiveUpload(anOp->targetNode, anOp->argument); break;
+    case FileOpType::DOWNLOAD_FOLDER:
+        theOperator->getRecursiveOp()->enactRecursiveDownload(anOp->targetNode, anOp->argument); break;
+    default:
+        return false;
+    }
+
+    return theOperator->operationIsPending();
+}
+
+RemoteDataReply * CWEfileOpScheduler::sendOpToConnection(FileOp * anOp)
+{
+    RemoteDataInterface * theConnection = cwe_globals::get_connection();
+    QString targetPath = anOp->targetNode.getFullPath();
+
+    switch (anOp->type)
+    {
+    case FileOpType::COPY:
+        return theConnection->copyFile(targetPath, siblingPath(targetPath, anOp->argument));
+    case FileOpType::MOVE:
+        return theConnection->moveFile(targetPath, siblingPath(targetPath, anOp->argument));
+    case FileOpType::RENAME:
+        return theConnection->renameFile(targetPath, anOp->argument);
+    case FileOpType::MAKE_FOLDER:
+        return theConnection->mkRemoteDir(targetPath, anOp->argument);
+    case FileOpType::UPLOAD:
+        return theConnection->uploadFile(targetPath, anOp->argument);
+    case FileOpType::UPLOAD_BUFFER:
+        return theConnection->uploadBuffer(targetPath, anOp->fileData, anOp->argument);
+    case FileOpType::DOWNLOAD:
+        return theConnection->downloadFile(anOp->argument, targetPath);
+    default:
+        return nullptr;
+    }
+}
+
+bool CWEfileOpScheduler::opNeedsOperator(FileOpType type)
+{
+    //Deletes go through the operator so the file tree marks the removed nodes,
+    //which the result caches watch for. Folder transfers are many requests.
+    return ((type == FileOpType::REMOVE) || (type == FileOpType::UPLOAD_FOLDER) ||
+            (type == FileOpType::DOWNLOAD_FOLDER));
+}
+
+void CWEfileOpScheduler::refreshAfterOp(const FileOp &doneOp)
+{
+    //Operations sent on the connection do not pass through the file operator,
+    //so the folders they change are listed again here
+    switch (doneOp.type)
+    {
+    case FileOpType::MAKE_FOLDER:
+    case FileOpType::UPLOAD:
+    case FileOpType::UPLOAD_BUFFER:
+        if (!doneOp.targetNode.isNil()) doneOp.targetNode.enactFolderRefresh();
+        return;
+    case FileOpType::COPY:
+    case FileOpType::MOVE:
+    case FileOpType::RENAME:
+        for (const QString &aPath : doneOp.remotePaths)
+        {
+            refreshFolder(parentPath(aPath));
+        }
+        return;
+    default:
+        return;
+    }
+}
+
+void CWEfileOpScheduler::refreshFolder(QString folderPath)
+{
+    if (folderPath.isEmpty()) return;
+    FileNodeRef folderNode = cwe_globals::get_file_handle()->speculateFileWithName(folderPath, true);
+    if (folderNode.isNil()) return;
+    folderNode.enactFolderRefresh();
+}
+
+void CWEfileOpScheduler::finishOp(int queueIndex, bool opSucceeded, QString message)
+{
+    FileOp doneOp = opQueue.takeAt(queueIndex);
+    queueModel->removeRow(queueIndex);
+
+    if (doneOp.state == FileOpState::RUNNING)
+    {
+        runningCount--;
+        if (doneOp.viaOperator) operatorOpRunning = false;
+    }
+
+    if (!opSucceeded)
+    {
+        qCDebug(agaveAppLayer, "File operation on %s failed: %s",
+                qPrintable(doneOp.remotePaths.first()), qPrintable(message));
+    }
+
+    emit queueChanged();
+    emit opFinished(doneOp.opID, opSucceeded, message);
+}
+
+void CWEfileOpScheduler::scheduleStart()
+{
+    if (startQueued) return;
+    startQueued = true;
+    QTimer::singleShot(0, this, SLOT(startOps()));
+}
+
+void CWEfileOpScheduler::updateRow(int queueIndex)
+{
+    QStandardItem * statusItem = queueModel->item(queueIndex, 2);
+    if (statusItem == nullptr) return;
+
+    const FileOp &theOp = opQueue.at(queueIndex);
+    if (theOp.state == FileOpState::RUNNING)
+    {
+        statusItem->setText(QString("Running (%1 s)").arg(theOp.runTime.elapsed() / 1000));
+        return;
+    }
+
+    for (int i = 0; i < queueIndex; i++)
+    {
+        if (opsOverlap(opQueue.at(i), theOp))
+        {
+            statusItem->setText("Waiting on earlier operation");
+            return;
+        }
+    }
+    statusItem->setText("Queued");
+}
+
+bool CWEfileOpScheduler::opsOverlap(const FileOp &firstOp, const FileOp &secondOp)
+{
+    for (const QString &firstPath : firstOp.remotePaths)
+    {
+        for (const QString &secondPath : secondOp.remotePaths)
+        {
+            if (pathsOverlap(firstPath, secondPath)) return true;
+        }
+    }
+
+    for (const QString &firstPath : firstOp.localPaths)
+    {
+        for (const QString &secondPath : secondOp.localPaths)
+        {
+            if (pathsOverlap(firstPath, secondPath)) return true;
+        }
+    }
+    return false;
+}
+
+bool CWEfileOpScheduler::pathsOverlap(QString firstPath, QString secondPath)
+{
+    //Two paths overlap if they are the same, or one is inside the other
+    if (firstPath.isEmpty() || secondPath.isEmpty()) return true;
+    if (firstPath == secondPath) return true;
+
+    QString firstFolder = firstPath.endsWith('/') ? firstPath : firstPath + '/';
+    QString secondFolder = secondPath.endsWith('/') ? secondPath : secondPath + '/';
+
+    return (firstPath.startsWith(secondFolder) || secondPath.startsWith(firstFolder));
+}
+
+QString CWEfileOpScheduler::siblingPath(QString remotePath, QString newName)
+{
+    if (newName.startsWith('/')) return newName;
+
+    int lastSlash = remotePath.lastIndexOf('/');
+    if (lastSlash < 0) return newName;
+    return remotePath.left(lastSlash + 1).append(newName);
+}
+
+QString CWEfileOpScheduler::parentPath(QString remotePath)
+{
+    int lastSlash = remotePath.lastIndexOf('/');
+    if (lastSlash <= 0) return QString();
+    return remotePath.left(lastSlash);
+}
+
+QString CWEfileOpScheduler::childPath(QString folderPath, QString childName)
+{
+    if (folderPath.endsWith('/')) return folderPath.append(childName);
+    return folderPath.append('/').append(childName);
+}
+
+QString CWEfileOpScheduler::opDescription(FileOpType type)
+{
+    switch (type)
+    {
+    case FileOpType::COPY: return "Copy";
+    case FileOpType::MOVE: return "Move";
+    case FileOpType::RENAME: return "Rename";
+    case FileOpType::REMOVE: return "Delete";
+    case FileOpType::MAKE_FOLDER: return "New Folder";
+    case FileOpType::UPLOAD: return "Upload";
+    case FileOpType::UPLOAD_BUFFER: return "Save File";
+    case FileOpType::DOWNLOAD: return "Download";
+    case FileOpType::UPLOAD_FOLDER: return "Upload Folder";
+    case FileOpType::DOWNLOAD_FOLDER: return "Download Folder";
+    }
+    return "Unknown";
+}
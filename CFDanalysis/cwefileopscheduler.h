@@ -0,0 +1,151 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CWEFILEOPSCHEDULER_H
+#define CWEFILEOPSCHEDULER_H
+
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QByteArray>
+#include <QElapsedTimer>
+#include <QTimer>
+#include <QStandardItemModel>
+
+#include "remoteFiles/filenoderef.h"
+
+class RemoteDataReply;
+enum class RequestState;
+
+//Note: Remote file operations are queued here instead of being refused while
+//another is running. Each operation records the remote (and local) paths it
+//touches. An operation waits only for earlier operations on overlapping paths;
+//others are started as soon as there is room, up to CWE_FILE_OP_MAX_CONCURRENT.
+//Single-request operations are sent on the remote connection, and each is
+//finished by its own reply, so several can run at once. Deletes and folder
+//transfers still go through the file operator, which runs one at a time; only
+//one of these is started at once, and it is finished by fileOpDone.
+//Case-level creates, copies, deletes and downloads are queued here too. A
+//request sent to the file operator directly, outside the queue, holds back
+//every queued operation until it is done.
+
+#define CWE_FILE_OP_MAX_CONCURRENT 4
+
+enum class FileOpType {COPY, MOVE, RENAME, REMOVE, MAKE_FOLDER, UPLOAD, UPLOAD_BUFFER,
+                       DOWNLOAD, UPLOAD_FOLDER, DOWNLOAD_FOLDER};
+enum class FileOpState {QUEUED, RUNNING};
+
+class CWEfileOpScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CWEfileOpScheduler(QObject *parent = nullptr);
+
+    //Note: Each returns an ID to match against opFinished, or -1 if refused
+    int queueCopy(const FileNodeRef &targetNode, QString newPath);
+    int queueMove(const FileNodeRef &targetNode, QString newPath);
+    int queueRename(const FileNodeRef &targetNode, QString newName);
+    int queueDelete(const FileNodeRef &targetNode);
+    int queueCreateFolder(const FileNodeRef &parentFolder, QString folderName);
+    int queueUpload(const FileNodeRef &destFolder, QString localFile);
+    int queueBufferUpload(const FileNodeRef &destFolder, QByteArray fileData, QString fileName);
+    int queueDownload(const FileNodeRef &targetNode, QString localFile);
+    int queueFolderUpload(const FileNodeRef &destFolder, QString localFolder);
+    int queueFolderDownload(const FileNodeRef &targetFolder, QString localFolder);
+
+    bool cancelOp(int opID);
+    bool opIsPending(int opID);
+    bool pathIsBusy(QString remotePath);
+    int pendingOpCount();
+
+    QStandardItemModel * getQueueModel();
+
+signals:
+    void opStarted(int opID);
+    void opFinished(int opID, bool opSucceeded, QString message);
+    void queueChanged();
+
+private slots:
+    void fileOpDone(RequestState opState, QString message);
+    void opReplied(RequestState opState);
+    void startOps();
+    void refreshProgress();
+
+private:
+    struct FileOp
+    {
+        int opID;
+        FileOpType type;
+        FileOpState state;
+        FileNodeRef targetNode;
+        QString argument;
+        QByteArray fileData;
+        QStringList remotePaths;
+        QStringList localPaths;
+        QElapsedTimer runTime;
+        bool viaOperator = false;
+    };
+
+    int addOp(FileOp newOp);
+    bool sendOp(FileOp * anOp);
+    bool sendOpToOperator(FileOp * anOp);
+    RemoteDataReply * sendOpToConnection(FileOp * anOp);
+    static bool opNeedsOperator(FileOpType type);
+    void refreshAfterOp(const FileOp &doneOp);
+    static void refreshFolder(QString folderPath);
+    void finishOp(int queueIndex, bool opSucceeded, QString message);
+    void scheduleStart();
+    void updateRow(int queueIndex);
+
+    static bool opsOverlap(const FileOp &firstOp, const FileOp &secondOp);
+    static bool pathsOverlap(QString firstPath, QString secondPath);
+    static QString siblingPath(QString remotePath, QString newName);
+    static QString parentPath(QString remotePath);
+    static QString childPath(QString folderPath, QString childName);
+    static QString opDescription(FileOpType type);
+
+    QList<FileOp> opQueue;
+    int nextOpID = 0;
+    int runningCount = 0;
+    bool operatorOpRunning = false;
+    QMap<RemoteDataReply *, int> replyOps;
+    bool startQueued = false;
+
+    QStandardItemModel * queueModel;
+    QTimer progressTimer;
+};
+
+#endif // CWEFILEOPSCHEDULER_H
@@ -45,6 +45,7 @@
 #include "cwe_guiWidgets/cwe_results.h"
 #include "cweanalysistype.h"
 #include "cwe_globals.h"
+#include "cwefilechangedispatcher.h"
 
 cweResultInstance::cweResultInstance(QString stageName, RESULT_ENTRY resultData, CWE_Results *parent) : QObject(parent)
 {
@@ -52,8 +53,9 @@ cweResultInstance::cweResultInstance(QString stageName, RESULT_ENTRY resultData,
     myResultData = resultData;
     myParent = parent;
 
-    QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileSystemChange(FileNodeRef)),
-                     this, SLOT(recomputeResultState()), Qt::QueuedConnection);
+    QString stagePath = myParent->getCaseFolder().getFullPath();
+    stagePath.append("/").append(myStage);
+    cwe_globals::get_file_dispatcher()->subscribe(stagePath, this, SLOT(recomputeResultState()));
 
     if (myResultData.type == "text")
     {
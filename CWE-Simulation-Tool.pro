@@ -42,7 +42,7 @@ NEEDED_PRI=$$PWD/../$$NEEDED_REPO/"$$NEEDED_REPO".pri
 
 include($$NEEDED_PRI)
 
-QT += core gui network
+QT += core gui network concurrent
 
 greaterThan(QT_MAJOR_VERSION, 4): QT += widgets
 
@@ -70,6 +70,14 @@ SOURCES += \
     mainWindow/cwe_mainwindow.cpp \
     visualUtils/cfdglcanvas.cpp \
     visualUtils/cfdtoken.cpp \
+    visualUtils/cfdlistscanner.cpp \
+    visualUtils/cfdnumberscanner.cpp \
+    visualUtils/cfdmeshdata.cpp \
+    visualUtils/cfdloadservice.cpp \
+    visualUtils/cfdmeshcache.cpp \
+    visualUtils/cfdbuffercache.cpp \
+    visualUtils/cfdfetchscheduler.cpp \
+    visualUtils/cfdprefetcher.cpp \
     visualUtils/decompresswrapper.cpp \
     cwe_guiWidgets/cwe_super.cpp \
     cwe_guiWidgets/cwe_help.cpp \
@@ -93,8 +101,12 @@ SOURCES += \
     visualUtils/resultVisuals/resulttextdisp.cpp \
     cwe_guiWidgets/cwe_file_manager.cpp \
     CFDanalysis/cwejobaccountant.cpp \
+    CFDanalysis/cwefilechangedispatcher.cpp \
+    CFDanalysis/cwecasesweep.cpp \
+    CFDanalysis/cwefileopscheduler.cpp \
     popupWindows/create_case_popup.cpp \
     popupWindows/duplicate_case_popup.cpp \
+    popupWindows/sweep_case_popup.cpp \
     SimCenter_widgets/sctrtextdatawidget.cpp \
     popupWindows/cwe_popup.cpp \
     utilWindows/dialogabout.cpp \
@@ -114,6 +126,14 @@ SOURCES += \
 HEADERS  += \
     visualUtils/cfdglcanvas.h \
     visualUtils/cfdtoken.h \
+    visualUtils/cfdlistscanner.h \
+    visualUtils/cfdnumberscanner.h \
+    visualUtils/cfdmeshdata.h \
+    visualUtils/cfdloadservice.h \
+    visualUtils/cfdmeshcache.h \
+    visualUtils/cfdbuffercache.h \
+    visualUtils/cfdfetchscheduler.h \
+    visualUtils/cfdprefetcher.h \
     visualUtils/decompresswrapper.h \
     mainWindow/cwe_mainwindow.h \
     cwe_guiWidgets/cwe_super.h \
@@ -138,8 +158,12 @@ HEADERS  += \
     visualUtils/resultVisuals/resulttextdisp.h \
     cwe_guiWidgets/cwe_file_manager.h \
     CFDanalysis/cwejobaccountant.h \
+    CFDanalysis/cwefilechangedispatcher.h \
+    CFDanalysis/cwecasesweep.h \
+    CFDanalysis/cwefileopscheduler.h \
     popupWindows/create_case_popup.h \
     popupWindows/duplicate_case_popup.h \
+    popupWindows/sweep_case_popup.h \
     SimCenter_widgets/sctrtextdatawidget.h \
     popupWindows/cwe_popup.h \
     utilWindows/dialogabout.h \
@@ -36,8 +36,22 @@
 #include "cwe_globals.h"
 
 #include "cwe_interfacedriver.h"
+#include "visualUtils/cfdloadservice.h"
+#include "visualUtils/cfdmeshcache.h"
+#include "visualUtils/cfdbuffercache.h"
+#include "visualUtils/cfdfetchscheduler.h"
+#include "visualUtils/cfdprefetcher.h"
+#include "CFDanalysis/cwefilechangedispatcher.h"
+#include "CFDanalysis/cwefileopscheduler.h"
 
 CWEjobAccountant * cwe_globals::theJobAccountant = nullptr;
+CFDloadService * cwe_globals::theLoadService = nullptr;
+CFDmeshCache * cwe_globals::theMeshCache = nullptr;
+CFDbufferCache * cwe_globals::theBufferCache = nullptr;
+CFDfetchScheduler * cwe_globals::theFetchScheduler = nullptr;
+CFDprefetcher * cwe_globals::thePrefetcher = nullptr;
+CWEfileChangeDispatcher * cwe_globals::theFileDispatcher = nullptr;
+CWEfileOpScheduler * cwe_globals::theFileOpScheduler = nullptr;
 
 cwe_globals::cwe_globals() {}
 
@@ -62,3 +76,66 @@ CWEjobAccountant * cwe_globals::get_CWE_Job_Accountant()
 {
     return theJobAccountant;
 }
+
+CFDloadService * cwe_globals::get_load_service()
+{
+    if (theLoadService == nullptr)
+    {
+        theLoadService = new CFDloadService();
+    }
+    return theLoadService;
+}
+
+CFDmeshCache * cwe_globals::get_mesh_cache()
+{
+    if (theMeshCache == nullptr)
+    {
+        theMeshCache = new CFDmeshCache();
+    }
+    return theMeshCache;
+}
+
+CFDbufferCache * cwe_globals::get_buffer_cache()
+{
+    if (theBufferCache == nullptr)
+    {
+        theBufferCache = new CFDbufferCache();
+    }
+    return theBufferCache;
+}
+
+CFDfetchScheduler * cwe_globals::get_fetch_scheduler()
+{
+    if (theFetchScheduler == nullptr)
+    {
+        theFetchScheduler = new CFDfetchScheduler();
+    }
+    return theFetchScheduler;
+}
+
+CFDprefetcher * cwe_globals::get_prefetcher()
+{
+    if (thePrefetcher == nullptr)
+    {
+        thePrefetcher = new CFDprefetcher();
+    }
+    return thePrefetcher;
+}
+
+CWEfileChangeDispatcher * cwe_globals::get_file_dispatcher()
+{
+    if (theFileDispatcher == nullptr)
+    {
+        theFileDispatcher = new CWEfileChangeDispatcher();
+    }
+    return theFileDispatcher;
+}
+
+CWEfileOpScheduler * cwe_globals::get_file_op_scheduler()
+{
+    if (theFileOpScheduler == nullptr)
+    {
+        theFileOpScheduler = new CWEfileOpScheduler();
+    }
+    return theFileOpScheduler;
+}
@@ -40,6 +40,13 @@
 #include "CFDanalysis/cwejobaccountant.h"
 
 class CWE_InterfaceDriver;
+class CFDloadService;
+class CFDmeshCache;
+class CFDbufferCache;
+class CFDfetchScheduler;
+class CFDprefetcher;
+class CWEfileChangeDispatcher;
+class CWEfileOpScheduler;
 
 class cwe_globals : public ae_globals
 {
@@ -49,9 +56,23 @@ public:
     static CWE_InterfaceDriver * get_CWE_Driver();
     static void set_CWE_Job_Accountant(CWEjobAccountant * theAccountant);
     static CWEjobAccountant * get_CWE_Job_Accountant();
+    static CFDloadService * get_load_service();
+    static CFDmeshCache * get_mesh_cache();
+    static CFDbufferCache * get_buffer_cache();
+    static CFDfetchScheduler * get_fetch_scheduler();
+    static CFDprefetcher * get_prefetcher();
+    static CWEfileChangeDispatcher * get_file_dispatcher();
+    static CWEfileOpScheduler * get_file_op_scheduler();
 
 private:
     static CWEjobAccountant * theJobAccountant;
+    static CFDloadService * theLoadService;
+    static CFDmeshCache * theMeshCache;
+    static CFDbufferCache * theBufferCache;
+    static CFDfetchScheduler * theFetchScheduler;
+    static CFDprefetcher * thePrefetcher;
+    static CWEfileChangeDispatcher * theFileDispatcher;
+    static CWEfileOpScheduler * theFileOpScheduler;
 };
 
 #endif // CWE_GLOBALS_H
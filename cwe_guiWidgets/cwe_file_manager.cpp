@@ -40,13 +40,13 @@
 
 #include "remoteFiles/filetreenode.h"
 #include "remoteFiles/fileoperator.h"
-#include "remoteFiles/filerecursiveoperator.h"
 #include "utilFuncs/singlelinedialog.h"
 
 #include "mainWindow/cwe_mainwindow.h"
 
 #include "cwe_interfacedriver.h"
 #include "cwe_globals.h"
+#include "CFDanalysis/cwefileopscheduler.h"
 
 CWE_file_manager::CWE_file_manager(QWidget *parent) :
     CWE_Super(parent),
@@ -84,22 +84,16 @@ void CWE_file_manager::linkMainWindow(CWE_MainWindow *theMainWin)
         ui->remoteTreeView->linkToFileOperator(cwe_globals::get_file_handle());
         QObject::connect(ui->remoteTreeView, SIGNAL(customContextMenuRequested(QPoint)),
                          this, SLOT(customFileMenu(QPoint)), Qt::QueuedConnection);
-        QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileOpDone(RequestState,QString)),
-                         this, SLOT(remoteOpDone(RequestState,QString)), Qt::QueuedConnection);
-        QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileOpStarted()),
-                         this, SLOT(remoteOpStarted()), Qt::QueuedConnection);
+        QObject::connect(cwe_globals::get_file_op_scheduler(), SIGNAL(opFinished(int,bool,QString)),
+                         this, SLOT(remoteOpDone(int,bool,QString)), Qt::QueuedConnection);
+        ui->opQueueView->setModel(cwe_globals::get_file_op_scheduler()->getQueueModel());
+        ui->opQueueView->header()->resizeSection(1,300);
         setControlsEnabled(true);
     }
 }
 
 void CWE_file_manager::on_pb_upload_clicked()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("Currently running file operation. Please Wait.");
-        return;
-    }
-
     FileNodeRef targetFile = ui->remoteTreeView->getSelectedFile();
 
     if ((targetFile.isNil()) || (targetFile.getFileType() != FileType::DIR))
@@ -111,13 +105,14 @@ void CWE_file_manager::on_pb_upload_clicked()
     QModelIndex localSelectIndex = ui->localTreeView->currentIndex();
     QFileInfo fileData = localFileModel->fileInfo(localSelectIndex);
 
+    int opID = -1;
     if (fileData.isDir())
     {
-        cwe_globals::get_file_handle()->getRecursiveOp()->enactRecursiveUpload(targetFile, fileData.absoluteFilePath());
+        opID = cwe_globals::get_file_op_scheduler()->queueFolderUpload(targetFile, fileData.absoluteFilePath());
     }
     else if (fileData.isFile())
     {
-        cwe_globals::get_file_handle()->sendUploadReq(targetFile, fileData.absoluteFilePath());
+        opID = cwe_globals::get_file_op_scheduler()->queueUpload(targetFile, fileData.absoluteFilePath());
     }
     else
     {
@@ -125,29 +120,11 @@ void CWE_file_manager::on_pb_upload_clicked()
         return;
     }
 
-    expectingOp = true;
-
-    if (!cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("Error: Unable to start file operation. Please try again.");
-        return;
-    }
-
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        setControlsEnabled(false);
-        expectingOp = true;
-    }
+    expectOp(opID);
 }
 
 void CWE_file_manager::on_pb_download_clicked()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("Currently running file operation. Please Wait.");
-        return;
-    }
-
     FileNodeRef targetFile = ui->remoteTreeView->getSelectedFile();
 
     if (targetFile.isNil())
@@ -166,6 +143,7 @@ void CWE_file_manager::on_pb_download_clicked()
     }
 
     QString localPath = fileData.absoluteFilePath();
+    int opID = -1;
 
     if (targetFile.getFileType() == FileType::FILE)
     {
@@ -176,56 +154,35 @@ void CWE_file_manager::on_pb_download_clicked()
         #endif
         localPath = localPath.append(targetFile.getFileName());
 
-        cwe_globals::get_file_handle()->sendDownloadReq(targetFile, localPath);
+        if (QFileInfo::exists(localPath))
+        {
+            cwe_globals::displayPopup("Error: Unable to start file operation. Please check that the local file does not already exist and try again.");
+            return;
+        }
+
+        opID = cwe_globals::get_file_op_scheduler()->queueDownload(targetFile, localPath);
     }
     else if (targetFile.getFileType() == FileType::DIR)
     {
-        cwe_globals::get_file_handle()->getRecursiveOp()->enactRecursiveDownload(targetFile, localPath);
-    }
-
-    if (!cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("Error: Unable to start file operation. Please check that the local file does not already exist and try again.");
-        return;
+        opID = cwe_globals::get_file_op_scheduler()->queueFolderDownload(targetFile, localPath);
     }
 
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        setControlsEnabled(false);
-        expectingOp = true;
-    }
+    expectOp(opID);
 }
 
 void CWE_file_manager::copyMenuItem()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("Currently running file operation. Please Wait.");
-        return;
-    }
-
     SingleLineDialog newNamePopup("Please type a file name to copy to:", "newname");
     if (newNamePopup.exec() != QDialog::Accepted)
     {
         return;
     }
 
-    cwe_globals::get_file_handle()->sendCopyReq(targetNode, newNamePopup.getInputText());
-
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        setControlsEnabled(false);
-        expectingOp = true;
-    }
+    expectOp(cwe_globals::get_file_op_scheduler()->queueCopy(targetNode, newNamePopup.getInputText()));
 }
 
 void CWE_file_manager::moveMenuItem()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("Currently running file operation. Please Wait.");
-        return;
-    }
     SingleLineDialog newNamePopup("Please type a file name to move to:", "newname");
 
     if (newNamePopup.exec() != QDialog::Accepted)
@@ -233,12 +190,7 @@ void CWE_file_manager::moveMenuItem()
         return;
     }
 
-    cwe_globals::get_file_handle()->sendMoveReq(targetNode,newNamePopup.getInputText());
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        setControlsEnabled(false);
-        expectingOp = true;
-    }
+    expectOp(cwe_globals::get_file_op_scheduler()->queueMove(targetNode, newNamePopup.getInputText()));
 }
 
 void CWE_file_manager::refreshMenuItem()
@@ -254,26 +206,13 @@ void CWE_file_manager::downloadBufferItem()
         return;
     }
     cwe_globals::get_file_handle()->sendDownloadBuffReq(targetNode);
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        setControlsEnabled(false);
-        expectingOp = true;
-    }
-}
-
-void CWE_file_manager::remoteOpStarted()
-{
-    setControlsEnabled(false);
 }
 
-void CWE_file_manager::remoteOpDone(RequestState operationStatus, QString message)
+void CWE_file_manager::remoteOpDone(int opID, bool opSucceeded, QString message)
 {
-    setControlsEnabled(true);
-
-    if (!expectingOp) return;
-    expectingOp = false;
+    if (!expectedOps.remove(opID)) return;
 
-    if (operationStatus != RequestState::GOOD)
+    if (!opSucceeded)
     {
         cwe_globals::displayPopup(message,"File Transfer Error");
     }
@@ -286,12 +225,6 @@ void CWE_file_manager::remoteOpDone(RequestState operationStatus, QString messag
 void CWE_file_manager::customFileMenu(const QPoint &pos)
 {
     QMenu fileMenu;
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        fileMenu.addAction("File Operation In Progress . . .");
-        fileMenu.exec(QCursor::pos());
-        return;
-    }
 
     QModelIndex targetIndex = ui->remoteTreeView->indexAt(pos);
     ui->remoteTreeView->fileEntryTouched(targetIndex);
@@ -325,12 +258,6 @@ void CWE_file_manager::customFileMenu(const QPoint &pos)
 
 void CWE_file_manager::button_newFolder_clicked()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("File Operation in progress. Please Wait.");
-        return;
-    }
-
     targetNode = ui->remoteTreeView->getSelectedFile();
 
     if (targetNode.getFileType() != FileType::DIR)
@@ -345,22 +272,11 @@ void CWE_file_manager::button_newFolder_clicked()
     {
         return;
     }
-    cwe_globals::get_file_handle()->sendCreateFolderReq(targetNode, newFolderNamePopup.getInputText());
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        setControlsEnabled(false);
-        expectingOp = true;
-    }
+    expectOp(cwe_globals::get_file_op_scheduler()->queueCreateFolder(targetNode, newFolderNamePopup.getInputText()));
 }
 
 void CWE_file_manager::button_delete_clicked()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("File Operation in progress. Please Wait.");
-        return;
-    }
-
     targetNode = ui->remoteTreeView->getSelectedFile();
     if (targetNode.isNil())
     {
@@ -375,23 +291,12 @@ void CWE_file_manager::button_delete_clicked()
 
     if (cwe_globals::get_file_handle()->deletePopup(targetNode))
     {
-        cwe_globals::get_file_handle()->sendDeleteReq(targetNode);
-        if (cwe_globals::get_file_handle()->operationIsPending())
-        {
-            setControlsEnabled(false);
-            expectingOp = true;
-        }
+        expectOp(cwe_globals::get_file_op_scheduler()->queueDelete(targetNode));
     }
 }
 
 void CWE_file_manager::button_rename_clicked()
 {
-    if (cwe_globals::get_file_handle()->operationIsPending())
-    {
-        cwe_globals::displayPopup("File Operation in progress. Please Wait.");
-        return;
-    }
-
     targetNode = ui->remoteTreeView->getSelectedFile();
 
     if (targetNode.isNil())
@@ -413,12 +318,17 @@ void CWE_file_manager::button_rename_clicked()
         return;
     }
 
-    cwe_globals::get_file_handle()->sendRenameReq(targetNode, newNamePopup.getInputText());
-    if (cwe_globals::get_file_handle()->operationIsPending())
+    expectOp(cwe_globals::get_file_op_scheduler()->queueRename(targetNode, newNamePopup.getInputText()));
+}
+
+void CWE_file_manager::expectOp(int opID)
+{
+    if (opID < 0)
     {
-        setControlsEnabled(false);
-        expectingOp = true;
+        cwe_globals::displayPopup("Error: Unable to start file operation. Please try again.");
+        return;
     }
+    expectedOps.insert(opID);
 }
 
 void CWE_file_manager::setControlsEnabled(bool newSetting)
@@ -41,9 +41,9 @@
 
 #include <QFileSystemModel>
 #include <QMenu>
+#include <QSet>
 
 class FileTreeNode;
-enum class RequestState;
 
 namespace Ui {
 class CWE_file_manager;
@@ -71,20 +71,20 @@ private slots:
 
     void downloadBufferItem();
 
-    void remoteOpStarted();
-    void remoteOpDone(RequestState operationStatus, QString message);
+    void remoteOpDone(int opID, bool opSucceeded, QString message);
 
     void button_newFolder_clicked();
     void button_delete_clicked();
     void button_rename_clicked();
 
 private:
+    void expectOp(int opID);
     void setControlsEnabled(bool newSetting);
     Ui::CWE_file_manager *ui;
     QFileSystemModel *localFileModel;
 
     FileNodeRef targetNode;
-    bool expectingOp = false;
+    QSet<int> expectedOps;
 };
 
 #endif // CWE_FILE_MANAGER2_H
@@ -40,6 +40,7 @@
 
 #include "popupWindows/create_case_popup.h"
 #include "popupWindows/duplicate_case_popup.h"
+#include "popupWindows/sweep_case_popup.h"
 
 #include "mainWindow/cwe_mainwindow.h"
 
@@ -92,6 +93,7 @@ void CWE_manage_simulation::newCaseGiven()
     clearSelectView();
 
     ui->pb_duplicateCase->setEnabled(false);
+    ui->pb_sweepCase->setEnabled(false);
     ui->pb_viewParameters->setEnabled(false);
     ui->pb_viewResults->setEnabled(false);
 
@@ -132,6 +134,7 @@ void CWE_manage_simulation::newCaseState(CaseState newState)
 
         showSelectView();
         ui->pb_duplicateCase->setEnabled(false);
+        ui->pb_sweepCase->setEnabled(false);
         ui->pb_viewParameters->setEnabled(false);
         ui->pb_viewResults->setEnabled(false);
         return;
@@ -153,6 +156,7 @@ void CWE_manage_simulation::newCaseState(CaseState newState)
         {
             clearSelectView();
             ui->pb_duplicateCase->setEnabled(false);
+            ui->pb_sweepCase->setEnabled(false);
             ui->pb_viewParameters->setEnabled(false);
             ui->pb_viewResults->setEnabled(false);
         }
@@ -172,6 +176,7 @@ void CWE_manage_simulation::newCaseState(CaseState newState)
         }
 
         ui->pb_duplicateCase->setEnabled(newState == CaseState::READY);
+        ui->pb_sweepCase->setEnabled(newState == CaseState::READY);
         ui->pb_viewParameters->setEnabled(true);
         ui->pb_viewResults->setEnabled((newState == CaseState::READY) || (newState == CaseState::READY_ERROR));
 
@@ -223,6 +228,19 @@ void CWE_manage_simulation::duplicate_case_clicked()
     duplicateCase->show();
 }
 
+void CWE_manage_simulation::on_pb_sweepCase_clicked()
+{
+    CWEcaseInstance * theCase = theMainWindow->getCurrentCase();
+    if ((theCase == nullptr) || (theCase->getMyType() == nullptr))
+    {
+        cwe_globals::displayPopup("Please select a case to sweep.");
+        return;
+    }
+
+    Sweep_Case_Popup * sweepCase = new Sweep_Case_Popup(theCase, theMainWindow, this);
+    sweepCase->show();
+}
+
 void CWE_manage_simulation::on_pb_viewParameters_clicked()
 {
     // switch main window to parameters tab
@@ -66,6 +66,7 @@ private slots:
 
     void create_new_case_clicked();
     void duplicate_case_clicked();
+    void on_pb_sweepCase_clicked();
     void on_pb_viewParameters_clicked();
     void on_pb_viewResults_clicked();
 
@@ -48,6 +48,7 @@
 
 #include "utilWindows/dialogabout.h"
 #include "popupWindows/dialoginflowparameters.h"
+#include "visualUtils/cfdprefetcher.h"
 
 CWE_MainWindow::CWE_MainWindow(QWidget *parent) :
     QMainWindow(parent),
@@ -378,3 +379,8 @@ void CWE_MainWindow::on_actionInflow_parameters_triggered()
     dlg->exec();
     delete dlg;
 }
+
+void CWE_MainWindow::on_actionPrefetch_Results_toggled(bool checked)
+{
+    cwe_globals::get_prefetcher()->setEnabled(checked);
+}
@@ -97,6 +97,8 @@ private slots:
 
     void on_actionInflow_parameters_triggered();
 
+    void on_actionPrefetch_Results_toggled(bool checked);
+
 private:
     void addWindowPanel(QWidget * thePanel, QString panelName, QString tabText);
     void deactivateCurrentCase();
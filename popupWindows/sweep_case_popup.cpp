@@ -0,0 +1,322 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "sweep_case_popup.h"
+
+#include "remoteFiles/remotefiletree.h"
+#include "remoteFiles/filetreenode.h"
+
+#include "CFDanalysis/cweanalysistype.h"
+#include "CFDanalysis/cwecaseinstance.h"
+#include "CFDanalysis/cwecasesweep.h"
+
+#include "mainWindow/cwe_mainwindow.h"
+#include "cwe_interfacedriver.h"
+
+#include "cwe_globals.h"
+
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QCheckBox>
+#include <QSpinBox>
+#include <QPushButton>
+#include <QLabel>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+#include <QFormLayout>
+#include <QSet>
+
+Sweep_Case_Popup::Sweep_Case_Popup(CWEcaseInstance * sourceCase, CWE_MainWindow *controlWindow, QWidget *parent) :
+    CWE_Popup(controlWindow, parent)
+{
+    this->setWindowTitle("Parameter Sweep");
+    this->setAttribute(Qt::WA_DeleteOnClose);
+
+    if (sourceCase != nullptr)
+    {
+        sweepType = sourceCase->getMyType();
+        baseParams = sourceCase->getCurrentParams();
+    }
+
+    QWidget * centralArea = new QWidget(this);
+    QVBoxLayout * mainLayout = new QVBoxLayout(centralArea);
+
+    QFormLayout * optionLayout = new QFormLayout();
+    baseNameEdit = new QLineEdit();
+    if (sourceCase != nullptr)
+    {
+        baseNameEdit->setText(sourceCase->getCaseName().append("_sweep"));
+    }
+    optionLayout->addRow("Base case name:", baseNameEdit);
+
+    gridEdit = new QPlainTextEdit();
+    gridEdit->setPlaceholderText("One parameter per line, as:\nparameterName: value1, value2, value3\n"
+                                 "A case is made for every combination of values.");
+    optionLayout->addRow("Parameter grid:", gridEdit);
+
+    submitFirstStageBox = new QCheckBox("Start the first stage of each case");
+    optionLayout->addRow("", submitFirstStageBox);
+
+    concurrentBox = new QSpinBox();
+    concurrentBox->setRange(1, 16);
+    concurrentBox->setValue(CWE_SWEEP_DEFAULT_CONCURRENT);
+    optionLayout->addRow("Cases in progress at once:", concurrentBox);
+
+    mainLayout->addLayout(optionLayout);
+
+    mainLayout->addWidget(new QLabel("Please select a folder to place the new cases:"));
+    folderTree = new RemoteFileTree(centralArea);
+    if (!cwe_globals::get_CWE_Driver()->inOfflineMode())
+    {
+        folderTree->linkToFileOperator(cwe_globals::get_file_handle());
+    }
+    mainLayout->addWidget(folderTree, 1);
+
+    QHBoxLayout * buttonLayout = new QHBoxLayout();
+    startButton = new QPushButton("Create Cases");
+    cancelButton = new QPushButton("Cancel Remaining");
+    cancelButton->setEnabled(false);
+    buttonLayout->addWidget(startButton);
+    buttonLayout->addWidget(cancelButton);
+    mainLayout->addLayout(buttonLayout);
+
+    summaryLabel = new QLabel();
+    mainLayout->addWidget(summaryLabel);
+
+    caseLog = new QPlainTextEdit();
+    caseLog->setReadOnly(true);
+    mainLayout->addWidget(caseLog, 1);
+
+    this->setCentralWidget(centralArea);
+
+    QObject::connect(startButton, SIGNAL(clicked()), this, SLOT(button_start_clicked()));
+    QObject::connect(cancelButton, SIGNAL(clicked()), this, SLOT(button_cancel_clicked()));
+}
+
+Sweep_Case_Popup::~Sweep_Case_Popup()
+{
+    //Cases already started are seen through after the popup closes
+    if (!activeSweep.isNull())
+    {
+        activeSweep->cancel();
+    }
+}
+
+void Sweep_Case_Popup::button_start_clicked()
+{
+    if (!activeSweep.isNull()) return;
+
+    if (cwe_globals::get_CWE_Driver()->inOfflineMode())
+    {
+        cwe_globals::displayPopup("Parameter sweeps are not available in offline mode.");
+        return;
+    }
+
+    if (sweepType == nullptr)
+    {
+        cwe_globals::displayPopup("Please select a valid case to sweep.");
+        return;
+    }
+
+    FileNodeRef selectedFolder = folderTree->getSelectedFile();
+    if (selectedFolder.isNil() || (selectedFolder.getFileType() != FileType::DIR))
+    {
+        cwe_globals::displayPopup("Please select a folder to place the new cases.");
+        return;
+    }
+
+    QString baseName = baseNameEdit->text();
+    if (!cwe_globals::isValidFolderName(baseName))
+    {
+        cwe_globals::displayPopup("Please input a valid folder name. Folder names should not include any special characters. (!, @, #, $, %, ^, etc.)");
+        return;
+    }
+
+    QMap<QString, QStringList> paramGrid;
+    if (!parseGrid(&paramGrid)) return;
+
+    QList<QMap<QString, QString>> variantList = CWEcaseSweep::expandGrid(paramGrid);
+    if (variantList.size() > CWE_SWEEP_MAX_CASES)
+    {
+        cwe_globals::displayPopup(QString("This grid makes %1 cases. Please keep sweeps to %2 cases or fewer.")
+                                  .arg(variantList.size()).arg(CWE_SWEEP_MAX_CASES));
+        return;
+    }
+
+    activeSweep = new CWEcaseSweep(sweepType, selectedFolder);
+    activeSweep->setSubmitFirstStage(submitFirstStageBox->isChecked());
+    activeSweep->setMaxConcurrent(concurrentBox->value());
+
+    int caseNum = 0;
+    for (const QMap<QString, QString> &aVariant : variantList)
+    {
+        QMap<QString, QString> caseParams = baseParams;
+        for (auto itr = aVariant.cbegin(); itr != aVariant.cend(); itr++)
+        {
+            caseParams[itr.key()] = itr.value();
+        }
+
+        caseNum++;
+        QString caseName = QString("%1_%2").arg(baseName).arg(caseNum, 3, 10, QChar('0'));
+        activeSweep->addCase(caseName, caseParams);
+    }
+
+    QObject::connect(activeSweep, SIGNAL(caseFinished(int)), this, SLOT(sweepCaseFinished(int)));
+    QObject::connect(activeSweep, SIGNAL(sweepFinished()), this, SLOT(sweepFinished()));
+    QObject::connect(activeSweep, SIGNAL(sweepFinished()), activeSweep, SLOT(deleteLater()));
+
+    if (!activeSweep->start())
+    {
+        cwe_globals::displayPopup("Unable to start the parameter sweep.");
+        activeSweep->deleteLater();
+        return;
+    }
+
+    startButton->setEnabled(false);
+    cancelButton->setEnabled(true);
+    updateSummary();
+}
+
+void Sweep_Case_Popup::button_cancel_clicked()
+{
+    if (activeSweep.isNull()) return;
+    activeSweep->cancel();
+    cancelButton->setEnabled(false);
+}
+
+void Sweep_Case_Popup::sweepCaseFinished(int caseIndex)
+{
+    if (activeSweep.isNull()) return;
+
+    QList<SWEEP_CASE> caseList = activeSweep->getCases();
+    if ((caseIndex < 0) || (caseIndex >= caseList.size())) return;
+    SWEEP_CASE theCase = caseList.at(caseIndex);
+
+    QString logLine = theCase.caseName;
+    logLine.append((theCase.step == SweepCaseStep::DONE) ? " - OK - " : " - FAILED - ");
+    logLine.append(theCase.message);
+    if (theCase.msecTaken >= 0)
+    {
+        logLine.append(QString(" (%1 s)").arg(theCase.msecTaken / 1000.0, 0, 'f', 1));
+    }
+    caseLog->appendPlainText(logLine);
+
+    updateSummary();
+}
+
+void Sweep_Case_Popup::sweepFinished()
+{
+    startButton->setEnabled(true);
+    cancelButton->setEnabled(false);
+    updateSummary();
+    caseLog->appendPlainText("Sweep finished.");
+}
+
+bool Sweep_Case_Popup::parseGrid(QMap<QString, QStringList> * paramGrid)
+{
+    QStringList gridLines = gridEdit->toPlainText().split('\n', QString::SkipEmptyParts);
+
+    //Note: A misspelled name would otherwise be written into every case, and silently do nothing
+    QSet<QString> knownParams;
+    for (const QString &stageId : sweepType->getStageIds())
+    {
+        TEMPLATE_STAGE aStage = sweepType->getStageFromId(stageId);
+        for (const TEMPLATE_GROUP &aGroup : aStage.groupList)
+        {
+            for (const PARAM_VARIABLE_TYPE &aVar : aGroup.varList)
+            {
+                knownParams.insert(aVar.internalName);
+            }
+        }
+    }
+
+    for (QString aLine : gridLines)
+    {
+        aLine = aLine.trimmed();
+        if (aLine.isEmpty()) continue;
+
+        int splitPos = aLine.indexOf(':');
+        if (splitPos <= 0)
+        {
+            cwe_globals::displayPopup(QString("Unable to read grid line: %1\nPlease use the form: parameterName: value1, value2").arg(aLine));
+            return false;
+        }
+
+        QString paramName = aLine.left(splitPos).trimmed();
+        QStringList paramValues;
+        for (QString aValue : aLine.mid(splitPos + 1).split(',', QString::SkipEmptyParts))
+        {
+            aValue = aValue.trimmed();
+            if (!aValue.isEmpty()) paramValues.append(aValue);
+        }
+
+        if (paramValues.isEmpty())
+        {
+            cwe_globals::displayPopup(QString("No values given for parameter: %1").arg(paramName));
+            return false;
+        }
+        if (!knownParams.contains(paramName))
+        {
+            cwe_globals::displayPopup(QString("Unknown parameter in grid: %1\nParameters must be given by their internal names for this analysis type.").arg(paramName));
+            return false;
+        }
+        if (paramGrid->contains(paramName))
+        {
+            cwe_globals::displayPopup(QString("Parameter given twice in grid: %1").arg(paramName));
+            return false;
+        }
+        paramGrid->insert(paramName, paramValues);
+    }
+
+    if (paramGrid->isEmpty())
+    {
+        cwe_globals::displayPopup("Please list at least one parameter and its values.");
+        return false;
+    }
+
+    return true;
+}
+
+void Sweep_Case_Popup::updateSummary()
+{
+    if (activeSweep.isNull()) return;
+
+    int totalCases = activeSweep->getCases().size();
+    int doneCases = activeSweep->countInStep(SweepCaseStep::DONE);
+    int failedCases = activeSweep->countInStep(SweepCaseStep::FAILED);
+
+    summaryLabel->setText(QString("%1 of %2 cases done, %3 failed. %4 cases per minute.")
+                          .arg(doneCases).arg(totalCases).arg(failedCases)
+                          .arg(activeSweep->getCasesPerMinute(), 0, 'f', 1));
+}
@@ -0,0 +1,91 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef SWEEP_CASE_POPUP_H
+#define SWEEP_CASE_POPUP_H
+
+#include "cwe_popup.h"
+
+#include <QMap>
+#include <QStringList>
+#include <QPointer>
+
+class CWEanalysisType;
+class CWEcaseInstance;
+class CWEcaseSweep;
+class RemoteFileTree;
+class QLineEdit;
+class QPlainTextEdit;
+class QCheckBox;
+class QSpinBox;
+class QPushButton;
+class QLabel;
+
+//Note: Cases are limited per sweep, to keep a typo in the grid from making thousands
+#define CWE_SWEEP_MAX_CASES 500
+
+class Sweep_Case_Popup : public CWE_Popup
+{
+    Q_OBJECT
+
+public:
+    explicit Sweep_Case_Popup(CWEcaseInstance * sourceCase, CWE_MainWindow * controlWindow, QWidget *parent = nullptr);
+    ~Sweep_Case_Popup();
+
+private slots:
+    void button_start_clicked();
+    void button_cancel_clicked();
+    void sweepCaseFinished(int caseIndex);
+    void sweepFinished();
+
+private:
+    bool parseGrid(QMap<QString, QStringList> * paramGrid);
+    void updateSummary();
+
+    CWEanalysisType * sweepType = nullptr;
+    QMap<QString, QString> baseParams;
+    QPointer<CWEcaseSweep> activeSweep;
+
+    RemoteFileTree * folderTree;
+    QLineEdit * baseNameEdit;
+    QPlainTextEdit * gridEdit;
+    QCheckBox * submitFirstStageBox;
+    QSpinBox * concurrentBox;
+    QPushButton * startButton;
+    QPushButton * cancelButton;
+    QLabel * summaryLabel;
+    QPlainTextEdit * caseLog;
+};
+
+#endif // SWEEP_CASE_POPUP_H
@@ -0,0 +1,64 @@
+##################################################################################
+#
+# Copyright (c) 2017 The University of Notre Dame
+# Copyright (c) 2017 The Regents of the University of California
+#
+# Redistribution and use in source and binary forms, with or without modification,
+# are permitted provided that the following conditions are met:
+#
+# 1. Redistributions of source code must retain the above copyright notice, this
+# list of conditions and the following disclaimer.
+#
+# 2. Redistributions in binary form must reproduce the above copyright notice, this
+# list of conditions and the following disclaimer in the documentation and/or other
+# materials provided with the distribution.
+#
+# 3. Neither the name of the copyright holder nor the names of its contributors may
+# be used to endorse or promote products derived from this software without specific
+# prior written permission.
+#
+# THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+# EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+# OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+# SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+# INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+# TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+# BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+# CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+# IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+# SUCH DAMAGE.
+#
+####################################################################################
+
+# Contributors:
+
+#Note: Correctness tests and benchmarks for the CFD file readers.
+#Run benchmarks alone with: ./tst_cfdparse -functions, then name one.
+#Set CFD_BENCH_POLYMESH to an ascii polyMesh folder to also bench real mesh files.
+
+QT += core concurrent testlib
+QT -= gui
+
+CONFIG += console testcase
+CONFIG -= app_bundle
+
+TARGET = tst_cfdparse
+TEMPLATE = app
+
+DEFINES += QT_DEPRECATED_WARNINGS
+
+SRC_ROOT = $$PWD/../..
+INCLUDEPATH += $$SRC_ROOT
+
+SOURCES += \
+    tst_cfdparse.cpp \
+    $$SRC_ROOT/visualUtils/cfdtoken.cpp \
+    $$SRC_ROOT/visualUtils/cfdlistscanner.cpp \
+    $$SRC_ROOT/visualUtils/cfdnumberscanner.cpp \
+    $$SRC_ROOT/visualUtils/cfdmeshdata.cpp
+
+HEADERS += \
+    $$SRC_ROOT/visualUtils/cfdtoken.h \
+    $$SRC_ROOT/visualUtils/cfdlistscanner.h \
+    $$SRC_ROOT/visualUtils/cfdnumberscanner.h \
+    $$SRC_ROOT/visualUtils/cfdmeshdata.h
@@ -0,0 +1,869 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include <QtTest>
+#include <QByteArray>
+#include <QString>
+#include <QDir>
+#include <QFile>
+#include <QtEndian>
+#include <QThread>
+
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+#include "visualUtils/cfdtoken.h"
+#include "visualUtils/cfdnumberscanner.h"
+#include "visualUtils/cfdlistscanner.h"
+#include "visualUtils/cfdmeshdata.h"
+
+//Note: The generated files follow the layout OpenFOAM writes, with the usual
+//banner and separator comments, plus a comment on most lines. This is the worst
+//case for the comment handling, which is what these benchmarks are meant to watch.
+
+static QByteArray foamBanner(QByteArray className, QByteArray objectName)
+{
+    QByteArray ret;
+    ret.append("/*--------------------------------*- C++ -*----------------------------------*\\\n");
+    ret.append("| =========                 |                                                 |\n");
+    ret.append("| \\\\      /  F ield         | OpenFOAM: The Open Source CFD Toolbox           |\n");
+    ret.append("|  \\\\    /   O peration     | Version:  v1806                                 |\n");
+    ret.append("|   \\\\  /    A nd           | Web:      www.OpenFOAM.com                      |\n");
+    ret.append("|    \\\\/     M anipulation  |                                                 |\n");
+    ret.append("\\*---------------------------------------------------------------------------*/\n");
+    ret.append("FoamFile\n{\n");
+    ret.append("    version     2.0;\n");
+    ret.append("    format      ascii;\n");
+    ret.append("    class       ").append(className).append(";\n");
+    ret.append("    location    \"constant/polyMesh\";\n");
+    ret.append("    object      ").append(objectName).append(";\n");
+    ret.append("}\n");
+    ret.append("// * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * * //\n\n");
+    return ret;
+}
+
+static QByteArray commentHeavyBoundary(int patchCount, bool writeListSize = true)
+{
+    //OpenFOAM writes the patch count as the list size. The token tree checks
+    //a list size against its token count, which is two per patch, so
+    //inputs for the token tree leave the size out.
+    QByteArray ret = foamBanner("polyBoundaryMesh", "boundary");
+    if (writeListSize) ret.append(QByteArray::number(patchCount));
+    ret.append("\n(\n");
+
+    int startFace = 0;
+    for (int i = 0; i < patchCount; i++)
+    {
+        int faceCount = 10 + (i % 97);
+        ret.append("    // Patch ").append(QByteArray::number(i)).append(" from snappyHexMesh layer addition\n");
+        ret.append("    patch").append(QByteArray::number(i)).append("\n    {\n");
+        ret.append("        type            wall; // no-slip\n");
+        ret.append("        inGroups        List<word> 1(wall);\n");
+        if (i % 4 == 0)
+        {
+            ret.append("        /* refinement region ").append(QByteArray::number(i / 4)).append(",\n");
+            ret.append("           level (3 4) */\n");
+        }
+        ret.append("        nFaces          ").append(QByteArray::number(faceCount)).append("; // faces\n");
+        ret.append("        startFace       ").append(QByteArray::number(startFace)).append("; // offset\n");
+        ret.append("    }\n");
+        startFace += faceCount;
+    }
+
+    ret.append(")\n\n");
+    ret.append("// ************************************************************************* //\n");
+    return ret;
+}
+
+static QByteArray generatedPoints(int pointCount)
+{
+    QByteArray ret = foamBanner("vectorField", "points");
+    ret.append(QByteArray::number(pointCount)).append("\n(\n");
+
+    for (int i = 0; i < pointCount; i++)
+    {
+        double xVal = 0.001 * (i % 1000);
+        double yVal = -2.5 + 0.0003 * (i % 7919);
+        double zVal = 1.0e-4 * (i % 104729);
+        ret.append('(').append(QByteArray::number(xVal, 'g', 10)).append(' ');
+        ret.append(QByteArray::number(yVal, 'g', 10)).append(' ');
+        ret.append(QByteArray::number(zVal, 'g', 10)).append(")\n");
+    }
+
+    ret.append(")\n\n");
+    ret.append("// ************************************************************************* //\n");
+    return ret;
+}
+
+static QByteArray generatedLabels(int labelCount)
+{
+    QByteArray ret = foamBanner("labelList", "owner");
+    ret.append(QByteArray::number(labelCount)).append("\n(\n");
+
+    for (int i = 0; i < labelCount; i++)
+    {
+        ret.append(QByteArray::number((static_cast<qint64>(i) * 7919) % 1000003)).append('\n');
+    }
+
+    ret.append(")\n\n");
+    ret.append("// ************************************************************************* //\n");
+    return ret;
+}
+
+static QByteArray generatedFaces(int faceCount)
+{
+    //Face sizes vary, so chunk offsets must be rebased to line up
+    QByteArray ret = foamBanner("faceList", "faces");
+    ret.append(QByteArray::number(faceCount)).append("\n(\n");
+
+    for (int i = 0; i < faceCount; i++)
+    {
+        int faceSize = 3 + (i % 4);
+        ret.append(QByteArray::number(faceSize)).append('(');
+        for (int j = 0; j < faceSize; j++)
+        {
+            if (j != 0) ret.append(' ');
+            ret.append(QByteArray::number((i * 31 + j * 104729) % 1000003));
+        }
+        ret.append(")\n");
+    }
+
+    ret.append(")\n\n");
+    ret.append("// ************************************************************************* //\n");
+    return ret;
+}
+
+static QList<QByteArray> numberTokens(const QByteArray &fileData)
+{
+    //Splits the words of a file as the old lexer did, so that only the
+    //number reading differs between the benchmarks
+    QList<QByteArray> ret;
+    QByteArray oneToken;
+    for (char aLetter : fileData)
+    {
+        if (std::isspace(static_cast<unsigned char>(aLetter)) || (aLetter == '(') || (aLetter == ')'))
+        {
+            if (!oneToken.isEmpty()) ret.append(oneToken);
+            oneToken.clear();
+        }
+        else
+        {
+            oneToken.append(aLetter);
+        }
+    }
+    if (!oneToken.isEmpty()) ret.append(oneToken);
+    return ret;
+}
+
+static QByteArray binaryLabels64(const QVector<qint64> &labelList)
+{
+    QByteArray ret("FoamFile\n{\n    version 2.0;\n    format binary;\n");
+    ret.append("    arch \"LSB;label=64;scalar=64\";\n    class labelList;\n}\n");
+    ret.append(QByteArray::number(labelList.size())).append("\n(");
+    for (qint64 aLabel : labelList)
+    {
+        qint64 leLabel = qToLittleEndian(aLabel);
+        ret.append(reinterpret_cast<const char *>(&leLabel), sizeof(leLabel));
+    }
+    ret.append(")\n");
+    return ret;
+}
+
+static QByteArray binaryScalars64(const QVector<double> &scalarList)
+{
+    QByteArray ret("FoamFile\n{\n    version 2.0;\n    format binary;\n");
+    ret.append("    arch \"LSB;label=32;scalar=64\";\n    class volScalarField;\n}\n");
+    ret.append(QByteArray::number(scalarList.size())).append("\n(");
+    for (double aScalar : scalarList)
+    {
+        quint64 leScalar;
+        std::memcpy(&leScalar, &aScalar, sizeof(leScalar));
+        leScalar = qToLittleEndian(leScalar);
+        ret.append(reinterpret_cast<const char *>(&leScalar), sizeof(leScalar));
+    }
+    ret.append(")\n");
+    return ret;
+}
+
+static quint64 doubleBits(double aVal)
+{
+    quint64 ret;
+    std::memcpy(&ret, &aVal, sizeof(ret));
+    return ret;
+}
+
+static QByteArray legacyStripComments(QByteArray rawInput)
+{
+    //The comment stripping used before the one-pass version, kept to compare against.
+    //It does not end if a block comment is left open, so only give it closed ones.
+    while (rawInput.contains("/*"))
+    {
+        int startComment = rawInput.indexOf("/*");
+        int endComment = rawInput.indexOf("*/", startComment);
+        if (endComment == -1) break;
+        rawInput.remove(startComment, endComment - startComment + 2);
+    }
+
+    while (rawInput.contains("//"))
+    {
+        int startComment = rawInput.indexOf("//");
+        int endComment = rawInput.indexOf("\n", startComment);
+        if (endComment == -1) break;
+        rawInput.remove(startComment, endComment - startComment);
+    }
+    return rawInput;
+}
+
+class TestCFDparse : public QObject
+{
+    Q_OBJECT
+
+private slots:
+    void initTestCase();
+
+    void stripMatchesLegacy();
+    void stripUnclosedComment();
+    void stripKeepsDivision();
+    void lexifySkipsComments();
+    void lexifyBoundaryTree();
+
+    void readDoubles_data();
+    void readDoubles();
+    void rejectBadDoubles_data();
+    void rejectBadDoubles();
+    void readLabels_data();
+    void readLabels();
+    void tokenLabelRange();
+    void listSizeRange();
+    void readPointList();
+    void chunkedMatchesSinglePass();
+    void readBinaryLabels64();
+    void fieldStatsSkipNonFinite();
+    void checkMeshOwners();
+    void keepBoundaryFaces();
+
+    void benchStripComments();
+    void benchLegacyStripComments();
+    void benchLexifyBoundary();
+    void benchOldSetString_data();
+    void benchOldSetString();
+    void benchNumberScanner_data();
+    void benchNumberScanner();
+    void benchReadPoints();
+
+private:
+    void addNumberBenchRows();
+
+    QByteArray largeBoundary;
+    QByteArray smallBoundary;
+    QByteArray largeUnsizedBoundary;
+    QByteArray pointsFile;
+};
+
+void TestCFDparse::initTestCase()
+{
+    //About 4 MB, and about 50000 comments
+    largeBoundary = commentHeavyBoundary(16000);
+    //The old stripping is quadratic, so it gets a smaller file
+    smallBoundary = commentHeavyBoundary(1000);
+    largeUnsizedBoundary = commentHeavyBoundary(16000, false);
+    //About 7 MB, like a mesh of a few hundred thousand cells
+    pointsFile = generatedPoints(250000);
+}
+
+void TestCFDparse::stripMatchesLegacy()
+{
+    QByteArray newStrip = smallBoundary;
+    CFDtoken::stripCFDcomments(&newStrip);
+
+    QCOMPARE(newStrip, legacyStripComments(smallBoundary));
+    QVERIFY(!newStrip.contains("/*"));
+    QVERIFY(!newStrip.contains("//"));
+}
+
+void TestCFDparse::stripUnclosedComment()
+{
+    //The old stripping never returned on this input
+    QByteArray testInput("a b /* not closed\n c d");
+    CFDtoken::stripCFDcomments(&testInput);
+    QCOMPARE(testInput, QByteArray("a b "));
+
+    QByteArray lineInput("a b // last line, no newline");
+    CFDtoken::stripCFDcomments(&lineInput);
+    QCOMPARE(lineInput, QByteArray("a b "));
+}
+
+void TestCFDparse::stripKeepsDivision()
+{
+    QByteArray testInput("x 1/2 y/ z\n");
+    CFDtoken::stripCFDcomments(&testInput);
+    QCOMPARE(testInput, QByteArray("x 1/2 y/ z\n"));
+}
+
+void TestCFDparse::lexifySkipsComments()
+{
+    QByteArray testInput("alpha/* one */beta // two\n 12 -3.5e2 ( ) /* three");
+    CFDtoken * rootToken = CFDtoken::lexifyString(&testInput);
+
+    CFDtokenSpan tokenList = rootToken->getChildList();
+    QCOMPARE(tokenList.size(), 6);
+
+    QCOMPARE(tokenList.at(0)->getType(), CFDtokenType::STRING);
+    QCOMPARE(tokenList.at(0)->getStringVal(), QByteArray("alpha"));
+    QCOMPARE(tokenList.at(1)->getType(), CFDtokenType::STRING);
+    QCOMPARE(tokenList.at(1)->getStringVal(), QByteArray("beta"));
+    QCOMPARE(tokenList.at(2)->getType(), CFDtokenType::INT);
+    QCOMPARE(tokenList.at(2)->getIntVal(), 12);
+    QCOMPARE(tokenList.at(3)->getType(), CFDtokenType::FLOAT);
+    QCOMPARE(tokenList.at(3)->getFloatVal(), -350.0);
+    QCOMPARE(tokenList.at(4)->getType(), CFDtokenType::SPECIAL_CHAR);
+    QCOMPARE(tokenList.at(5)->getType(), CFDtokenType::SPECIAL_CHAR);
+
+    //The input is left as it was
+    QVERIFY(testInput.contains("/* one */"));
+
+    delete rootToken;
+}
+
+void TestCFDparse::lexifyBoundaryTree()
+{
+    //The patch count does not match the token count, so the tree is refused
+    QByteArray sizedInput = smallBoundary;
+    CFDtoken * sizedToken = CFDtoken::lexifyString(&sizedInput);
+    QVERIFY(!CFDtoken::parseTokenStream(sizedToken));
+    delete sizedToken;
+
+    QByteArray testInput = commentHeavyBoundary(1000, false);
+    CFDtoken * rootToken = CFDtoken::lexifyString(&testInput);
+    QVERIFY(CFDtoken::parseTokenStream(rootToken));
+
+    CFDtoken * patchList = rootToken->getLargestChildArray();
+    QVERIFY(patchList != nullptr);
+    //Each patch is a name, then a {} block
+    QCOMPARE(patchList->getChildSize(), 2000);
+
+    delete rootToken;
+}
+
+void TestCFDparse::readDoubles_data()
+{
+    QTest::addColumn<QByteArray>("input");
+    QTest::addColumn<double>("expected");
+
+    //The fast path needs the mantissa to be at most 2^53
+    QTest::newRow("2^53") << QByteArray("9007199254740992") << 9007199254740992.0;
+    QTest::newRow("2^53+1") << QByteArray("9007199254740993") << 9007199254740993.0;
+    QTest::newRow("-(2^53+1)") << QByteArray("-9007199254740993") << -9007199254740993.0;
+    QTest::newRow("2^53+1 decimal") << QByteArray("9007199254740993.0") << 9007199254740993.0;
+    QTest::newRow("2^53 e22") << QByteArray("9007199254740992e22") << 9007199254740992e22;
+
+    //and the power of ten to be at most 10^22
+    QTest::newRow("1e22") << QByteArray("1e22") << 1e22;
+    QTest::newRow("1e-22") << QByteArray("1e-22") << 1e-22;
+    QTest::newRow("1.5e22") << QByteArray("1.5e22") << 1.5e22;
+    QTest::newRow("-4.25e-22") << QByteArray("-4.25e-22") << -4.25e-22;
+    QTest::newRow("89255.0e-22") << QByteArray("89255.0e-22") << 89255.0e-22;
+    QTest::newRow("9.999999999999999e22") << QByteArray("9.999999999999999e22") << 9.999999999999999e22;
+
+    //These must use the slow path
+    QTest::newRow("1e23") << QByteArray("1e23") << 1e23;
+    QTest::newRow("1e-23") << QByteArray("1e-23") << 1e-23;
+    QTest::newRow("small fraction") << QByteArray("0.000000000000000000000001") << 0.000000000000000000000001;
+    QTest::newRow("22 digits") << QByteArray("1234567890123456789012") << 1234567890123456789012.0;
+    QTest::newRow("long pi") << QByteArray("3.14159265358979323846") << 3.14159265358979323846;
+    QTest::newRow("max double") << QByteArray("1.7976931348623157e308") << 1.7976931348623157e308;
+    QTest::newRow("min normal") << QByteArray("2.2250738585072014e-308") << 2.2250738585072014e-308;
+    QTest::newRow("min denormal") << QByteArray("4.9e-324") << 4.9e-324;
+
+    QTest::newRow("0.1") << QByteArray("0.1") << 0.1;
+    QTest::newRow("trailing dot") << QByteArray("123.") << 123.0;
+    QTest::newRow("leading dot") << QByteArray(".5") << 0.5;
+    QTest::newRow("plus sign") << QByteArray("+2") << 2.0;
+    QTest::newRow("capital E") << QByteArray("-1.25E+03") << -1250.0;
+    QTest::newRow("negative zero") << QByteArray("-0.0") << -0.0;
+
+    //Diverged runs write these into ascii fields
+    double nanVal = std::numeric_limits<double>::quiet_NaN();
+    double infVal = std::numeric_limits<double>::infinity();
+    QTest::newRow("nan") << QByteArray("nan") << nanVal;
+    QTest::newRow("-nan") << QByteArray("-nan") << nanVal;
+    QTest::newRow("NaN") << QByteArray("NaN") << nanVal;
+    QTest::newRow("inf") << QByteArray("inf") << infVal;
+    QTest::newRow("+inf") << QByteArray("+inf") << infVal;
+    QTest::newRow("-inf") << QByteArray("-inf") << -infVal;
+    QTest::newRow("-Infinity") << QByteArray("-Infinity") << -infVal;
+    QTest::newRow("INF") << QByteArray("INF") << infVal;
+}
+
+void TestCFDparse::readDoubles()
+{
+    QFETCH(QByteArray, input);
+    QFETCH(double, expected);
+
+    double scanVal;
+    QVERIFY(CFDnumberScanner::readWholeDouble(input.constData(), input.size(), &scanVal));
+    //NaN bits vary, and its sign means nothing
+    if (qIsNaN(expected))
+    {
+        QVERIFY(qIsNaN(scanVal));
+        return;
+    }
+    //Compared bit for bit, as QCOMPARE on doubles is fuzzy
+    QCOMPARE(doubleBits(scanVal), doubleBits(expected));
+
+    bool okCheck;
+    double oldVal = input.toDouble(&okCheck);
+    if (okCheck)
+    {
+        QCOMPARE(doubleBits(scanVal), doubleBits(oldVal));
+    }
+}
+
+void TestCFDparse::rejectBadDoubles_data()
+{
+    QTest::addColumn<QByteArray>("input");
+
+    QTest::newRow("two dots") << QByteArray("1.2.3");
+    QTest::newRow("no exponent") << QByteArray("1e");
+    QTest::newRow("no mantissa") << QByteArray("e5");
+    QTest::newRow("sign only") << QByteArray("-");
+    QTest::newRow("dot only") << QByteArray(".");
+    QTest::newRow("two numbers") << QByteArray("1-2");
+    QTest::newRow("word") << QByteArray("wall");
+    QTest::newRow("trailing letter") << QByteArray("1.5x");
+    QTest::newRow("longer word") << QByteArray("inflow");
+    QTest::newRow("nan then digit") << QByteArray("nan1");
+    QTest::newRow("partial word") << QByteArray("infin");
+    QTest::newRow("two signs") << QByteArray("--inf");
+}
+
+void TestCFDparse::rejectBadDoubles()
+{
+    QFETCH(QByteArray, input);
+
+    double scanVal;
+    QVERIFY(!CFDnumberScanner::readWholeDouble(input.constData(), input.size(), &scanVal));
+}
+
+void TestCFDparse::readLabels_data()
+{
+    QTest::addColumn<QByteArray>("input");
+    QTest::addColumn<bool>("valid");
+    QTest::addColumn<qint64>("expected");
+
+    QTest::newRow("zero") << QByteArray("0") << true << Q_INT64_C(0);
+    QTest::newRow("negative zero") << QByteArray("-0") << true << Q_INT64_C(0);
+    QTest::newRow("plus sign") << QByteArray("+7") << true << Q_INT64_C(7);
+    QTest::newRow("above int") << QByteArray("2147483648") << true << Q_INT64_C(2147483648);
+    QTest::newRow("below int") << QByteArray("-2147483649") << true << Q_INT64_C(-2147483649);
+    QTest::newRow("int64 max") << QByteArray("9223372036854775807") << true
+                               << std::numeric_limits<qint64>::max();
+    QTest::newRow("int64 min") << QByteArray("-9223372036854775808") << true
+                               << std::numeric_limits<qint64>::min();
+    QTest::newRow("above int64") << QByteArray("9223372036854775808") << false << Q_INT64_C(0);
+    QTest::newRow("below int64") << QByteArray("-9223372036854775809") << false << Q_INT64_C(0);
+    QTest::newRow("20 digits") << QByteArray("12345678901234567890") << false << Q_INT64_C(0);
+    QTest::newRow("decimal") << QByteArray("1.0") << false << Q_INT64_C(0);
+    QTest::newRow("exponent") << QByteArray("1e3") << false << Q_INT64_C(0);
+    QTest::newRow("trailing letter") << QByteArray("12a") << false << Q_INT64_C(0);
+}
+
+void TestCFDparse::readLabels()
+{
+    QFETCH(QByteArray, input);
+    QFETCH(bool, valid);
+    QFETCH(qint64, expected);
+
+    qint64 scanVal;
+    bool scanOk = CFDnumberScanner::readWholeLabel(input.constData(), input.size(), &scanVal);
+    QCOMPARE(scanOk, valid);
+    if (valid)
+    {
+        QCOMPARE(scanVal, expected);
+    }
+}
+
+void TestCFDparse::tokenLabelRange()
+{
+    //Labels too big for an int become floats, as they did with toInt
+    QByteArray testInput("2147483647 2147483648 -2147483648 -2147483649");
+    CFDtoken * rootToken = CFDtoken::lexifyString(&testInput);
+
+    CFDtokenSpan tokenList = rootToken->getChildList();
+    QCOMPARE(tokenList.size(), 4);
+    QCOMPARE(tokenList.at(0)->getType(), CFDtokenType::INT);
+    QCOMPARE(tokenList.at(0)->getIntVal(), std::numeric_limits<int>::max());
+    QCOMPARE(tokenList.at(1)->getType(), CFDtokenType::FLOAT);
+    QVERIFY(tokenList.at(1)->getFloatVal() == 2147483648.0);
+    QCOMPARE(tokenList.at(2)->getType(), CFDtokenType::INT);
+    QCOMPARE(tokenList.at(2)->getIntVal(), std::numeric_limits<int>::min());
+    QCOMPARE(tokenList.at(3)->getType(), CFDtokenType::FLOAT);
+
+    delete rootToken;
+}
+
+void TestCFDparse::listSizeRange()
+{
+    QVector<int> labelList;
+
+    QByteArray maxInput("2147483647\n(\n)\n");
+    CFDlistScanner maxScanner(&maxInput);
+    QVERIFY(maxScanner.seekDataList());
+    QCOMPARE(maxScanner.getListSize(), std::numeric_limits<int>::max());
+
+    //Sizes too big for an int are not list sizes, so no list is found
+    QByteArray bigInput("2147483648\n(\n1\n)\n");
+    QVERIFY(!CFDtoken::readLabelList(&bigInput, &labelList));
+    QByteArray longInput("123456789012345678901234567890\n(\n1\n)\n");
+    QVERIFY(!CFDtoken::readLabelList(&longInput, &labelList));
+}
+
+void TestCFDparse::readPointList()
+{
+    QByteArray testInput = generatedPoints(5000);
+    QVector<double> pointList;
+    QVERIFY(CFDtoken::readVectorList(&testInput, 3, &pointList));
+    QCOMPARE(pointList.size(), 15000);
+
+    //Every value matches the old toDouble reading
+    QList<QByteArray> tokenList = numberTokens(testInput);
+    int listStart = tokenList.indexOf("5000") + 1;
+    QVERIFY(listStart > 0);
+    for (int i = 0; i < pointList.size(); i++)
+    {
+        bool okCheck;
+        double oldVal = tokenList.at(listStart + i).toDouble(&okCheck);
+        QVERIFY(okCheck);
+        QCOMPARE(doubleBits(pointList.at(i)), doubleBits(oldVal));
+    }
+}
+
+void TestCFDparse::chunkedMatchesSinglePass()
+{
+    //Each list is above both chunking thresholds, so is split when there are cores for it
+    if (QThread::idealThreadCount() < 2) QSKIP("Chunked reading needs more than one core");
+
+    QByteArray labelFile = generatedLabels(400000);
+    QByteArray faceFile = generatedFaces(200000);
+    QVERIFY(labelFile.size() > 2 * CFD_CHUNKED_MIN_BYTES);
+    QVERIFY(faceFile.size() > 2 * CFD_CHUNKED_MIN_BYTES);
+
+    QVector<double> chunkPoints, onePassPoints;
+    for (bool allowChunks : {true, false})
+    {
+        CFDlistScanner theScanner(&pointsFile);
+        theScanner.setChunkedReading(allowChunks);
+        QVERIFY(theScanner.seekDataList());
+        QVERIFY(theScanner.readVectors(3, allowChunks ? &chunkPoints : &onePassPoints));
+        QCOMPARE(theScanner.lastReadWasChunked(), allowChunks);
+    }
+    QCOMPARE(chunkPoints.size(), 750000);
+    QCOMPARE(chunkPoints.size(), onePassPoints.size());
+    for (int i = 0; i < chunkPoints.size(); i++)
+    {
+        if (doubleBits(chunkPoints.at(i)) != doubleBits(onePassPoints.at(i)))
+        {
+            QFAIL(qPrintable(QString("Point value %1 differs").arg(i)));
+        }
+    }
+
+    QVector<int> chunkLabels, onePassLabels;
+    for (bool allowChunks : {true, false})
+    {
+        CFDlistScanner theScanner(&labelFile);
+        theScanner.setChunkedReading(allowChunks);
+        QVERIFY(theScanner.seekDataList());
+        QVERIFY(theScanner.readLabels(allowChunks ? &chunkLabels : &onePassLabels));
+        QCOMPARE(theScanner.lastReadWasChunked(), allowChunks);
+    }
+    QCOMPARE(chunkLabels.size(), 400000);
+    QCOMPARE(chunkLabels, onePassLabels);
+
+    QVector<int> chunkOffsets, chunkIndices, onePassOffsets, onePassIndices;
+    for (bool allowChunks : {true, false})
+    {
+        CFDlistScanner theScanner(&faceFile);
+        theScanner.setChunkedReading(allowChunks);
+        QVERIFY(theScanner.seekDataList());
+        QVERIFY(theScanner.readFaces(allowChunks ? &chunkOffsets : &onePassOffsets,
+                                     allowChunks ? &chunkIndices : &onePassIndices));
+        QCOMPARE(theScanner.lastReadWasChunked(), allowChunks);
+    }
+    QCOMPARE(chunkOffsets.size(), 200001);
+    QCOMPARE(chunkOffsets, onePassOffsets);
+    QCOMPARE(chunkIndices, onePassIndices);
+    QCOMPARE(chunkOffsets.last(), chunkIndices.size());
+}
+
+void TestCFDparse::readBinaryLabels64()
+{
+    QVector<int> labelList;
+
+    QByteArray goodInput = binaryLabels64({0, 7, -1, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()});
+    QVERIFY(CFDtoken::readLabelList(&goodInput, &labelList));
+    QCOMPARE(labelList, QVector<int>({0, 7, -1, std::numeric_limits<int>::max(), std::numeric_limits<int>::min()}));
+
+    //Our index arrays are int, so labels outside that are an error, not truncated
+    QByteArray bigInput = binaryLabels64({0, Q_INT64_C(2147483648), 2});
+    QVERIFY(!CFDtoken::readLabelList(&bigInput, &labelList));
+    QVERIFY(labelList.isEmpty());
+
+    QByteArray smallInput = binaryLabels64({0, Q_INT64_C(-2147483649)});
+    QVERIFY(!CFDtoken::readLabelList(&smallInput, &labelList));
+
+    QByteArray wrapInput = binaryLabels64({Q_INT64_C(4294967297)});
+    QVERIFY(!CFDtoken::readLabelList(&wrapInput, &labelList));
+}
+
+void TestCFDparse::fieldStatsSkipNonFinite()
+{
+    //Diverged runs write NaN and inf, in binary and ascii files alike.
+    //A NaN first value used to leave min and max as NaN.
+    double nanVal = std::numeric_limits<double>::quiet_NaN();
+    double infVal = std::numeric_limits<double>::infinity();
+    QByteArray testInput = binaryScalars64({nanVal, 3.0, -1.0, infVal, 2.0, -infVal});
+
+    CFDfieldData testField;
+    QVERIFY(testField.readField(&testInput, "scalar"));
+    QCOMPARE(testField.getValues().size(), 6);
+
+    QCOMPARE(testField.getMin(), -1.0);
+    QCOMPARE(testField.getMax(), 3.0);
+    QCOMPARE(testField.getMean(), 4.0 / 3.0);
+
+    int histogramTotal = 0;
+    for (int binCount : testField.getHistogram()) histogramTotal += binCount;
+    QCOMPARE(histogramTotal, 3);
+
+    QCOMPARE(testField.getPercentile(0.0), -1.0);
+    QCOMPARE(testField.getPercentile(50.0), 2.0);
+    QCOMPARE(testField.getPercentile(100.0), 3.0);
+
+    QByteArray asciiInput = foamBanner("volScalarField", "p");
+    asciiInput.append("dimensions [0 2 -2 0 0 0 0];\n\n");
+    asciiInput.append("internalField nonuniform List<scalar>\n6\n(\nnan\n3\n-1\ninf\n2\n-inf\n)\n;\n");
+    CFDfieldData asciiField;
+    QVERIFY(asciiField.readField(&asciiInput, "scalar"));
+    QCOMPARE(asciiField.getValues().size(), 6);
+    QVERIFY(qIsNaN(asciiField.getValues().at(0)));
+    QCOMPARE(asciiField.getMin(), -1.0);
+    QCOMPARE(asciiField.getMax(), 3.0);
+    QCOMPARE(asciiField.getMean(), 4.0 / 3.0);
+    QCOMPARE(asciiField.getPercentile(50.0), 2.0);
+
+    QByteArray allNanInput = binaryScalars64({nanVal, nanVal});
+    CFDfieldData nanField;
+    QVERIFY(nanField.readField(&allNanInput, "scalar"));
+    QCOMPARE(nanField.getMin(), 0.0);
+    QCOMPARE(nanField.getMax(), 0.0);
+    QCOMPARE(nanField.getPercentile(50.0), 0.0);
+}
+
+void TestCFDparse::checkMeshOwners()
+{
+    //One triangle face, so the owner list must have exactly one label
+    QByteArray pointInput("3\n(\n(0 0 0)\n(1 0 0)\n(0 1 0)\n)\n");
+    QByteArray faceInput("1\n(\n3(0 1 2)\n)\n");
+
+    QByteArray goodOwners("1\n(\n0\n)\n");
+    CFDmeshData goodMesh;
+    QVERIFY(goodMesh.readPoints(&pointInput));
+    QVERIFY(goodMesh.readFaces(&faceInput));
+    QVERIFY(goodMesh.readOwners(&goodOwners));
+    QVERIFY(goodMesh.checkMesh());
+
+    QByteArray extraOwners("2\n(\n0\n0\n)\n");
+    CFDmeshData extraMesh;
+    QVERIFY(extraMesh.readPoints(&pointInput));
+    QVERIFY(extraMesh.readFaces(&faceInput));
+    QVERIFY(extraMesh.readOwners(&extraOwners));
+    QVERIFY(!extraMesh.checkMesh());
+
+    QByteArray negativeOwners("1\n(\n-1\n)\n");
+    CFDmeshData negativeMesh;
+    QVERIFY(negativeMesh.readPoints(&pointInput));
+    QVERIFY(negativeMesh.readFaces(&faceInput));
+    QVERIFY(negativeMesh.readOwners(&negativeOwners));
+    QVERIFY(!negativeMesh.checkMesh());
+}
+
+void TestCFDparse::keepBoundaryFaces()
+{
+    //Face 0 is internal; faces 1 and 2 make up the one patch
+    QByteArray pointInput("4\n(\n(0 0 0)\n(1 0 0)\n(0 1 0)\n(0 0 1)\n)\n");
+    QByteArray faceInput("3\n(\n3(0 1 2)\n4(0 1 3 2)\n3(1 2 3)\n)\n");
+    QByteArray ownerInput("3\n(\n0\n0\n1\n)\n");
+    QByteArray boundaryInput("1\n(\n    walls\n    {\n        type wall;\n"
+                             "        nFaces 2;\n        startFace 1;\n    }\n)\n");
+
+    CFDmeshData theMesh;
+    QVERIFY(theMesh.readPoints(&pointInput));
+    QVERIFY(theMesh.readFaces(&faceInput));
+    QVERIFY(theMesh.readOwners(&ownerInput));
+    QVERIFY(theMesh.readBoundary(&boundaryInput));
+    QVERIFY(theMesh.checkMesh());
+
+    theMesh.keepBoundaryFaces();
+    QCOMPARE(theMesh.getFaceCount(), 2);
+    QCOMPARE(theMesh.getFaceOffsets(), QVector<int>({0, 4, 7}));
+    QCOMPARE(theMesh.getFaceIndices(), QVector<int>({0, 1, 3, 2, 1, 2, 3}));
+    QCOMPARE(theMesh.getOwners(), QVector<int>({0, 1}));
+    QCOMPARE(theMesh.getPatches().size(), 1);
+    QCOMPARE(theMesh.getPatches().first().startFace, 0);
+    QVERIFY(theMesh.checkMesh());
+}
+
+void TestCFDparse::benchStripComments()
+{
+    QBENCHMARK
+    {
+        QByteArray workBuffer = largeBoundary;
+        workBuffer.detach();
+        CFDtoken::stripCFDcomments(&workBuffer);
+    }
+}
+
+void TestCFDparse::benchLegacyStripComments()
+{
+    QBENCHMARK
+    {
+        QByteArray stripped = legacyStripComments(smallBoundary);
+        Q_UNUSED(stripped);
+    }
+}
+
+void TestCFDparse::benchLexifyBoundary()
+{
+    QBENCHMARK
+    {
+        CFDtoken * rootToken = CFDtoken::lexifyString(&largeUnsizedBoundary);
+        bool parsed = CFDtoken::parseTokenStream(rootToken);
+        delete rootToken;
+        QVERIFY(parsed);
+    }
+}
+
+void TestCFDparse::addNumberBenchRows()
+{
+    QTest::addColumn<QByteArray>("fileData");
+
+    QTest::newRow("generated points") << pointsFile;
+
+    //Note: Real meshes are not in the repo. Point CFD_BENCH_POLYMESH at an
+    //uncompressed ascii constant/polyMesh folder to bench those too.
+    QByteArray meshFolder = qgetenv("CFD_BENCH_POLYMESH");
+    if (meshFolder.isEmpty()) return;
+
+    QDir meshDir(QString::fromLocal8Bit(meshFolder));
+    for (const char * fileName : {"points", "faces", "owner", "neighbour"})
+    {
+        QFile meshFile(meshDir.filePath(fileName));
+        if (!meshFile.open(QIODevice::ReadOnly)) continue;
+        QTest::newRow(fileName) << meshFile.readAll();
+    }
+}
+
+void TestCFDparse::benchOldSetString_data()
+{
+    addNumberBenchRows();
+}
+
+void TestCFDparse::benchOldSetString()
+{
+    //The number reading CFDtoken::setString did before CFDnumberScanner
+    QFETCH(QByteArray, fileData);
+    QList<QByteArray> tokenList = numberTokens(fileData);
+
+    int numberCount = 0;
+    QBENCHMARK
+    {
+        numberCount = 0;
+        for (const QByteArray &aToken : tokenList)
+        {
+            bool okCheck;
+            int intVal = aToken.toInt(&okCheck);
+            Q_UNUSED(intVal);
+            if (!okCheck)
+            {
+                double floatVal = aToken.toDouble(&okCheck);
+                Q_UNUSED(floatVal);
+            }
+            if (okCheck) numberCount++;
+        }
+    }
+    QVERIFY(numberCount > 0);
+}
+
+void TestCFDparse::benchNumberScanner_data()
+{
+    addNumberBenchRows();
+}
+
+void TestCFDparse::benchNumberScanner()
+{
+    QFETCH(QByteArray, fileData);
+    QList<QByteArray> tokenList = numberTokens(fileData);
+
+    int numberCount = 0;
+    QBENCHMARK
+    {
+        numberCount = 0;
+        for (const QByteArray &aToken : tokenList)
+        {
+            qint64 labelVal;
+            double floatVal;
+            if (CFDnumberScanner::readWholeLabel(aToken.constData(), aToken.size(), &labelVal) ||
+                    CFDnumberScanner::readWholeDouble(aToken.constData(), aToken.size(), &floatVal))
+            {
+                numberCount++;
+            }
+        }
+    }
+    QVERIFY(numberCount > 0);
+}
+
+void TestCFDparse::benchReadPoints()
+{
+    QVector<double> pointList;
+    QBENCHMARK
+    {
+        CFDtoken::readVectorList(&pointsFile, 3, &pointList);
+    }
+    QCOMPARE(pointList.size(), 750000);
+}
+
+QTEST_APPLESS_MAIN(TestCFDparse)
+
+#include "tst_cfdparse.moc"
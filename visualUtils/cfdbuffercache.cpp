@@ -0,0 +1,338 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdbuffercache.h"
+
+#include "cwe_globals.h"
+#include "cfdloadservice.h"
+#include "CFDanalysis/cwefilechangedispatcher.h"
+
+#include "remoteFiles/filenoderef.h"
+#include "remoteFiles/filetreenode.h"
+#include "filemetadata.h"
+
+#include <QCryptographicHash>
+#include <QFile>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QTextStream>
+#include <QTimer>
+
+CFDbufferCache::CFDbufferCache(QObject *parent) : QObject(parent)
+{
+    QString cachePath = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    if (cachePath.isEmpty()) return;
+
+    cacheDir.setPath(cachePath);
+    if (!cacheDir.mkpath("resultBuffers")) return;
+    indexFilePath = cacheDir.filePath("resultBuffers.index");
+    if (!cacheDir.cd("resultBuffers")) return;
+
+    loadIndex();
+
+    //Files not in the index could never be purged, so they are not kept
+    for (QFileInfo aFile : cacheDir.entryInfoList(QDir::Files))
+    {
+        if (!cacheFileIndex.contains(aFile.fileName()))
+        {
+            QFile::remove(aFile.absoluteFilePath());
+            continue;
+        }
+        totalBytes += aFile.size();
+    }
+
+    cacheUsable = true;
+    enforceCap();
+}
+
+bool CFDbufferCache::hasBuffer(FileNodeRef remoteFile)
+{
+    qint64 remoteSize;
+    QString cacheFileName = cacheFileFor(remoteFile, &remoteSize);
+    if (cacheFileName.isEmpty()) return false;
+    if (!entryExtant(cacheFileName)) return false;
+
+    QFileInfo cacheFile(cacheDir.filePath(cacheFileName));
+    return (cacheFile.size() == remoteSize);
+}
+
+bool CFDbufferCache::fetchBuffer(FileNodeRef remoteFile)
+{
+    qint64 remoteSize;
+    QString cacheFileName = cacheFileFor(remoteFile, &remoteSize);
+    if (cacheFileName.isEmpty()) return false;
+
+    if (pendingTasks.contains(cacheFileName))
+    {
+        //A read already under way will answer this too. A write is not yet readable.
+        return (cacheFileIndex.contains(cacheFileName));
+    }
+    if (!entryExtant(cacheFileName)) return false;
+
+    pendingTasks.insert(cacheFileName, remoteFile.getFullPath());
+    watchRemotePath(remoteFile.getFullPath());
+    cwe_globals::get_load_service()->submitCacheRead(remoteFile.getFullPath(), cacheDir.filePath(cacheFileName), remoteSize,
+                                                     this, SLOT(cacheTaskDone(CFDcacheTask*)));
+    return true;
+}
+
+void CFDbufferCache::storeBuffer(FileNodeRef remoteFile, const QByteArray &fileBuffer)
+{
+    qint64 remoteSize;
+    QString cacheFileName = cacheFileFor(remoteFile, &remoteSize);
+    if (cacheFileName.isEmpty()) return;
+    if (fileBuffer.size() != remoteSize) return;
+    if (fileBuffer.size() > CFD_BUFFER_CACHE_CAP / 4) return;
+
+    if (pendingTasks.contains(cacheFileName)) return;
+    if (entryExtant(cacheFileName)) return;
+
+    pendingTasks.insert(cacheFileName, remoteFile.getFullPath());
+    watchRemotePath(remoteFile.getFullPath());
+    cwe_globals::get_load_service()->submitCacheWrite(remoteFile.getFullPath(), cacheDir.filePath(cacheFileName), fileBuffer,
+                                                      this, SLOT(cacheTaskDone(CFDcacheTask*)));
+}
+
+void CFDbufferCache::cacheTaskDone(CFDcacheTask * theTask)
+{
+    QString cacheFileName = QFileInfo(theTask->getCacheFilePath()).fileName();
+    QString remotePath = theTask->getRemotePath();
+    pendingTasks.remove(cacheFileName);
+
+    //A task whose remote file was deleted while it ran must not bring back the old data
+    bool isStale = staleTasks.remove(cacheFileName);
+
+    if (theTask->getType() == CacheTaskType::READ)
+    {
+        QByteArray fileBuffer = theTask->takeBuffer();
+        if (!theTask->taskSucceeded())
+        {
+            removeEntry(cacheFileName, true);
+        }
+        if (isStale || !theTask->taskSucceeded())
+        {
+            fileBuffer.clear();
+        }
+        releaseRemotePath(remotePath);
+        emit bufferFetched(remotePath, fileBuffer);
+        return;
+    }
+
+    if (!theTask->taskSucceeded() || isStale)
+    {
+        if (isStale) QFile::remove(theTask->getCacheFilePath());
+        releaseRemotePath(remotePath);
+        return;
+    }
+
+    totalBytes += theTask->getExpectedSize();
+    addEntry(remotePath, cacheFileName);
+    enforceCap();
+    emit bufferStored(remotePath);
+}
+
+void CFDbufferCache::fileChanged(FileNodeRef changedFile)
+{
+    if (changedFile.isNil()) return;
+    if (changedFile.getNodeState() != NodeState::DELETING) return;
+
+    purgePath(changedFile.getFullPath());
+}
+
+QString CFDbufferCache::cacheFileFor(FileNodeRef remoteFile, qint64 * remoteSize)
+{
+    QString ret;
+    if (!cacheUsable) return ret;
+    if (remoteFile.isNil()) return ret;
+
+    *remoteSize = remoteFile.getFileData().getSize();
+    if (*remoteSize <= 0) return ret;
+
+    QByteArray cacheKey = remoteFile.getFullPath().toUtf8();
+    cacheKey.append('\n').append(QByteArray::number(*remoteSize));
+
+    ret = QString::fromLatin1(QCryptographicHash::hash(cacheKey, QCryptographicHash::Sha1).toHex());
+    return ret;
+}
+
+bool CFDbufferCache::entryExtant(QString cacheFileName)
+{
+    if (!cacheFileIndex.contains(cacheFileName)) return false;
+    if (QFile::exists(cacheDir.filePath(cacheFileName))) return true;
+
+    removeEntry(cacheFileName, false);
+    return false;
+}
+
+void CFDbufferCache::addEntry(QString remotePath, QString cacheFileName)
+{
+    cacheFileIndex.insert(cacheFileName, remotePath);
+    pathIndex[remotePath].insert(cacheFileName);
+    watchRemotePath(remotePath);
+    queueIndexSave();
+}
+
+void CFDbufferCache::removeEntry(QString cacheFileName, bool removeFile)
+{
+    if (removeFile)
+    {
+        QFileInfo cacheFile(cacheDir.filePath(cacheFileName));
+        if (cacheFile.exists() && QFile::remove(cacheFile.absoluteFilePath()))
+        {
+            totalBytes -= cacheFile.size();
+        }
+    }
+
+    if (!cacheFileIndex.contains(cacheFileName)) return;
+
+    QString remotePath = cacheFileIndex.take(cacheFileName);
+    pathIndex[remotePath].remove(cacheFileName);
+    if (pathIndex.value(remotePath).isEmpty())
+    {
+        pathIndex.remove(remotePath);
+        releaseRemotePath(remotePath);
+    }
+    queueIndexSave();
+}
+
+void CFDbufferCache::watchRemotePath(QString remotePath)
+{
+    //Deleting the file, or any folder above it, is what purges its entries
+    cwe_globals::get_file_dispatcher()->watchPath(remotePath, this, SLOT(fileChanged(FileNodeRef)));
+}
+
+void CFDbufferCache::releaseRemotePath(QString remotePath)
+{
+    if (pathIndex.contains(remotePath)) return;
+    for (const QString &aPath : pendingTasks)
+    {
+        if (aPath == remotePath) return;
+    }
+    cwe_globals::get_file_dispatcher()->unwatchPath(remotePath, this, SLOT(fileChanged(FileNodeRef)));
+}
+
+void CFDbufferCache::purgePath(QString remotePath)
+{
+    //Removes everything cached at or below the given path
+    QString folderPrefix = remotePath.endsWith('/') ? remotePath : remotePath + '/';
+
+    QStringList doomedFiles;
+    for (auto itr = pathIndex.lowerBound(remotePath); itr != pathIndex.end(); itr++)
+    {
+        if ((itr.key() != remotePath) && !itr.key().startsWith(folderPrefix)) break;
+        doomedFiles.append((*itr).values());
+    }
+
+    for (const QString &cacheFileName : doomedFiles)
+    {
+        removeEntry(cacheFileName, true);
+    }
+
+    for (auto itr = pendingTasks.cbegin(); itr != pendingTasks.cend(); itr++)
+    {
+        if ((*itr == remotePath) || (*itr).startsWith(folderPrefix))
+        {
+            staleTasks.insert(itr.key());
+        }
+    }
+}
+
+void CFDbufferCache::loadIndex()
+{
+    QFile indexFile(indexFilePath);
+    if (!indexFile.open(QIODevice::ReadOnly | QIODevice::Text)) return;
+
+    QTextStream indexStream(&indexFile);
+    indexStream.setCodec("UTF-8");
+    while (!indexStream.atEnd())
+    {
+        QString aLine = indexStream.readLine();
+        int splitPos = aLine.indexOf('\t');
+        if (splitPos <= 0) continue;
+
+        QString cacheFileName = aLine.left(splitPos);
+        QString remotePath = aLine.mid(splitPos + 1);
+        cacheFileIndex.insert(cacheFileName, remotePath);
+        pathIndex[remotePath].insert(cacheFileName);
+        watchRemotePath(remotePath);
+    }
+}
+
+void CFDbufferCache::queueIndexSave()
+{
+    if (indexSaveQueued) return;
+    indexSaveQueued = true;
+    QTimer::singleShot(0, this, SLOT(saveIndex()));
+}
+
+void CFDbufferCache::saveIndex()
+{
+    //Note: The index is small, one line per cached file
+    indexSaveQueued = false;
+
+    QSaveFile indexFile(indexFilePath);
+    if (!indexFile.open(QIODevice::WriteOnly | QIODevice::Text)) return;
+
+    QTextStream indexStream(&indexFile);
+    indexStream.setCodec("UTF-8");
+    for (auto itr = cacheFileIndex.cbegin(); itr != cacheFileIndex.cend(); itr++)
+    {
+        indexStream << itr.key() << '\t' << (*itr) << '\n';
+    }
+    indexStream.flush();
+    indexFile.commit();
+}
+
+void CFDbufferCache::enforceCap()
+{
+    if (totalBytes <= CFD_BUFFER_CACHE_CAP) return;
+
+    //Oldest first
+    QFileInfoList cacheFiles = cacheDir.entryInfoList(QDir::Files, QDir::Time | QDir::Reversed);
+
+    totalBytes = 0;
+    for (const QFileInfo &aFile : cacheFiles)
+    {
+        totalBytes += aFile.size();
+    }
+
+    for (const QFileInfo &aFile : cacheFiles)
+    {
+        if (totalBytes <= CFD_BUFFER_CACHE_CAP) return;
+        //Files being read are left alone
+        if (pendingTasks.contains(aFile.fileName())) continue;
+        removeEntry(aFile.fileName(), true);
+    }
+}
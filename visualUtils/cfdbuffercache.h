@@ -0,0 +1,103 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDBUFFERCACHE_H
+#define CFDBUFFERCACHE_H
+
+#include <QObject>
+#include <QByteArray>
+#include <QDir>
+#include <QMap>
+#include <QSet>
+#include <QString>
+
+class FileNodeRef;
+class CFDcacheTask;
+
+//Note: Downloaded result files are kept on local disk between sessions.
+//Each file is stored under a hash of its remote path and size. An index from
+//remote path to cache file is kept beside the cache, so that when a stage
+//folder is deleted (as in a rollback), its cached results are removed before
+//the stage can be re-run. Files least recently used are removed past the cap.
+//Reads and writes run on the load service. A read ends with bufferFetched,
+//a write with bufferStored.
+
+#define CFD_BUFFER_CACHE_CAP (2LL * 1024 * 1024 * 1024)
+
+class CFDbufferCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CFDbufferCache(QObject *parent = nullptr);
+
+    bool hasBuffer(FileNodeRef remoteFile);
+    bool fetchBuffer(FileNodeRef remoteFile);
+    //Note: Returns false if the file is not cached. Otherwise, bufferFetched
+    //follows, with an empty buffer if the cached copy proved bad.
+    void storeBuffer(FileNodeRef remoteFile, const QByteArray &fileBuffer);
+
+signals:
+    void bufferFetched(QString remotePath, QByteArray fileBuffer);
+    void bufferStored(QString remotePath);
+
+private slots:
+    void cacheTaskDone(CFDcacheTask * theTask);
+    void fileChanged(FileNodeRef changedFile);
+    void saveIndex();
+
+private:
+    QString cacheFileFor(FileNodeRef remoteFile, qint64 * remoteSize);
+    bool entryExtant(QString cacheFileName);
+    void addEntry(QString remotePath, QString cacheFileName);
+    void removeEntry(QString cacheFileName, bool removeFile);
+    void watchRemotePath(QString remotePath);
+    void releaseRemotePath(QString remotePath);
+    void purgePath(QString remotePath);
+    void loadIndex();
+    void queueIndexSave();
+    void enforceCap();
+
+    QDir cacheDir;
+    QString indexFilePath;
+    bool cacheUsable = false;
+    qint64 totalBytes = 0;
+
+    QMap<QString, QSet<QString>> pathIndex;
+    QMap<QString, QString> cacheFileIndex;
+    QMap<QString, QString> pendingTasks;
+    QSet<QString> staleTasks;
+    bool indexSaveQueued = false;
+};
+
+#endif // CFDBUFFERCACHE_H
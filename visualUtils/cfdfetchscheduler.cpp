@@ -0,0 +1,157 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdfetchscheduler.h"
+
+#include "cwe_globals.h"
+#include "remotedatainterface.h"
+
+#include "remoteFiles/filetreenode.h"
+
+CFDfetchScheduler::CFDfetchScheduler(QObject *parent) : QObject(parent) {}
+
+void CFDfetchScheduler::requestFile(FileNodeRef fileNode, FetchPriority priority)
+{
+    if (fileNode.isNil()) return;
+    if (fileNode.fileBufferLoaded()) return;
+
+    QString filePath = fileNode.getFullPath();
+    if (inFlightFetches.contains(filePath)) return;
+
+    if (waitingFetches.contains(filePath))
+    {
+        //A prefetch asked for again by a visible popup moves to the front
+        if ((priority == FetchPriority::VISIBLE) &&
+                (waitingFetches[filePath].priority == FetchPriority::PREFETCH))
+        {
+            waitingFetches[filePath].priority = FetchPriority::VISIBLE;
+            waitingOrder.removeOne(filePath);
+            waitingOrder.prepend(filePath);
+        }
+        startFetches();
+        return;
+    }
+
+    FetchEntry newEntry;
+    newEntry.fileNode = fileNode;
+    newEntry.priority = priority;
+    queueEntry(filePath, newEntry);
+
+    startFetches();
+}
+
+bool CFDfetchScheduler::fileIsPending(FileNodeRef fileNode)
+{
+    if (fileNode.isNil()) return false;
+    QString filePath = fileNode.getFullPath();
+    return (inFlightFetches.contains(filePath) || waitingFetches.contains(filePath));
+}
+
+void CFDfetchScheduler::bufferReplied(RequestState replyState, QByteArray fileBuffer)
+{
+    RemoteDataReply * theReply = qobject_cast<RemoteDataReply *>(QObject::sender());
+    if (!replyPaths.contains(theReply)) return;
+
+    //The path stays pending until its own reply is in, so it is never asked for twice
+    QString filePath = replyPaths.take(theReply);
+    FetchEntry theEntry = inFlightFetches.take(filePath);
+
+    if (replyState == RequestState::GOOD)
+    {
+        if (!theEntry.fileNode.isNil() && !theEntry.fileNode.fileBufferLoaded())
+        {
+            theEntry.fileNode.setFileBuffer(&fileBuffer);
+        }
+        startFetches();
+        return;
+    }
+
+    theEntry.failCount++;
+    if (theEntry.failCount <= CFD_FETCH_MAX_RETRIES)
+    {
+        qCDebug(agaveAppLayer, "Download of %s failed, trying again", qPrintable(filePath));
+        queueEntry(filePath, theEntry);
+    }
+    else
+    {
+        qCDebug(agaveAppLayer, "Download of %s failed", qPrintable(filePath));
+        emit fetchFailed(filePath);
+    }
+    startFetches();
+}
+
+void CFDfetchScheduler::queueEntry(QString filePath, FetchEntry newEntry)
+{
+    waitingFetches[filePath] = newEntry;
+
+    if (newEntry.priority == FetchPriority::PREFETCH)
+    {
+        waitingOrder.append(filePath);
+        return;
+    }
+
+    //Visible files go after other visible files, but before prefetches
+    int insertPos = 0;
+    while ((insertPos < waitingOrder.size()) &&
+           (waitingFetches[waitingOrder.at(insertPos)].priority == FetchPriority::VISIBLE))
+    {
+        insertPos++;
+    }
+    waitingOrder.insert(insertPos, filePath);
+}
+
+void CFDfetchScheduler::startFetches()
+{
+    while ((inFlightFetches.size() < CFD_FETCH_MAX_CONCURRENT) && !waitingOrder.isEmpty())
+    {
+        QString filePath = waitingOrder.takeFirst();
+        FetchEntry theEntry = waitingFetches.take(filePath);
+
+        if (theEntry.fileNode.isNil()) continue;
+        if (theEntry.fileNode.fileBufferLoaded()) continue;
+
+        RemoteDataReply * theReply = cwe_globals::get_connection()->downloadBuffer(filePath);
+        if (theReply == nullptr)
+        {
+            qCDebug(agaveAppLayer, "Unable to start download of %s", qPrintable(filePath));
+            emit fetchFailed(filePath);
+            continue;
+        }
+
+        inFlightFetches[filePath] = theEntry;
+        replyPaths[theReply] = filePath;
+        QObject::connect(theReply, SIGNAL(haveBufferDownloadReply(RequestState,QByteArray)),
+                         this, SLOT(bufferReplied(RequestState,QByteArray)));
+    }
+}
@@ -0,0 +1,92 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDFETCHSCHEDULER_H
+#define CFDFETCHSCHEDULER_H
+
+#include <QObject>
+#include <QMap>
+#include <QList>
+#include <QString>
+#include <QByteArray>
+
+#include "remoteFiles/filenoderef.h"
+
+class RemoteDataReply;
+enum class RequestState;
+
+//Note: All result file downloads go through here. A file already queued or
+//downloading is not asked for again. Up to CFD_FETCH_MAX_CONCURRENT downloads
+//run at once, and files for a visible popup go ahead of any prefetch.
+//Each download is tracked by its own reply, however long it takes. A failed
+//download is tried again up to CFD_FETCH_MAX_RETRIES times, then reported.
+
+#define CFD_FETCH_MAX_CONCURRENT 4
+#define CFD_FETCH_MAX_RETRIES 2
+
+enum class FetchPriority {VISIBLE, PREFETCH};
+
+class CFDfetchScheduler : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CFDfetchScheduler(QObject *parent = nullptr);
+
+    void requestFile(FileNodeRef fileNode, FetchPriority priority);
+    bool fileIsPending(FileNodeRef fileNode);
+
+signals:
+    void fetchFailed(QString remotePath);
+
+private slots:
+    void bufferReplied(RequestState replyState, QByteArray fileBuffer);
+
+private:
+    struct FetchEntry
+    {
+        FileNodeRef fileNode;
+        FetchPriority priority;
+        int failCount = 0;
+    };
+
+    void queueEntry(QString filePath, FetchEntry newEntry);
+    void startFetches();
+
+    QMap<QString, FetchEntry> waitingFetches;
+    QList<QString> waitingOrder;
+    QMap<QString, FetchEntry> inFlightFetches;
+    QMap<RemoteDataReply *, QString> replyPaths;
+};
+
+#endif // CFDFETCHSCHEDULER_H
@@ -35,108 +35,126 @@
 
 #include "cfdglcanvas.h"
 
-#include "cfdtoken.h"
-
-CFDglCanvas::CFDglCanvas(QWidget *parent, Qt::WindowFlags f) : QOpenGLWidget(parent,f) {}
+#include <QOpenGLContext>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <algorithm>
+
+static const char * canvasVertexShader =
+        "#version 330 core\n"
+        "layout(location = 0) in vec3 vertexPos;\n"
+        "layout(location = 1) in float vertexVal;\n"
+        "uniform mat4 mvpMat;\n"
+        "flat out float faceVal;\n"
+        "void main()\n"
+        "{\n"
+        "    faceVal = vertexVal;\n"
+        "    gl_Position = mvpMat * vec4(vertexPos, 1.0);\n"
+        "}\n";
+
+//The color scale runs from blue through white to red
+static const char * canvasFragmentShader =
+        "#version 330 core\n"
+        "flat in float faceVal;\n"
+        "uniform int useDataColor;\n"
+        "uniform float lowVal;\n"
+        "uniform float highVal;\n"
+        "out vec4 fragColor;\n"
+        "void main()\n"
+        "{\n"
+        "    if (useDataColor == 0)\n"
+        "    {\n"
+        "        fragColor = vec4(0.0, 0.0, 0.0, 1.0);\n"
+        "        return;\n"
+        "    }\n"
+        "    float dataVal = clamp((faceVal - lowVal) / max(highVal - lowVal, 1e-30), 0.0, 1.0);\n"
+        "    vec3 faceColor = vec3(1.0, 0.0, 1.0);\n"
+        "    if (dataVal > 0.5)\n"
+        "    {\n"
+        "        faceColor.b = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);\n"
+        "        faceColor.g = faceColor.b;\n"
+        "    }\n"
+        "    else\n"
+        "    {\n"
+        "        faceColor.r = 0.3 + 0.7 * (dataVal / 0.5);\n"
+        "        faceColor.g = faceColor.r;\n"
+        "    }\n"
+        "    fragColor = vec4(faceColor, 1.0);\n"
+        "}\n";
+
+CFDglCanvas::CFDglCanvas(QWidget *parent, Qt::WindowFlags f) : QOpenGLWidget(parent,f),
+    pointBuffer(QOpenGLBuffer::VertexBuffer), lineIndexBuffer(QOpenGLBuffer::IndexBuffer),
+    fillVertexBuffer(QOpenGLBuffer::VertexBuffer), fillIndexBuffer(QOpenGLBuffer::IndexBuffer)
+{
+    QSurfaceFormat glFormat = format();
+    glFormat.setVersion(3, 3);
+    glFormat.setProfile(QSurfaceFormat::CoreProfile);
+    setFormat(glFormat);
+}
 
 CFDglCanvas::~CFDglCanvas()
 {
+    cleanupGL();
     clearAllData();
 }
 
-bool CFDglCanvas::loadFieldData(QByteArray * rawDataFile, QString valueType)
+bool CFDglCanvas::loadFieldData(QSharedPointer<const CFDfieldData> theField)
 {
-    CFDtoken * dataRoot = CFDtoken::lexifyString(rawDataFile);
-
-    if (!CFDtoken::parseTokenStream(dataRoot))
+    if (theField.isNull() || !theField->getError().isEmpty() || theField->getValues().isEmpty())
     {
         currentDisplayError = "Unable to read data file";
-        delete dataRoot;
         return false;
     }
 
-    CFDtoken * dataElement = dataRoot->getLargestChildArray();
-
-    if (dataElement == nullptr)
+    //Every face's owner cell must have a value, as faces are colored by it
+    int maxOwner = -1;
+    for (int aOwner : ownerList)
     {
-        currentDisplayError = "Unable to locate data in data file";
-        delete dataRoot;
-        return false;
+        if (aOwner > maxOwner) maxOwner = aOwner;
     }
-
-    if (valueType == "scalar")
+    if (maxOwner >= theField->getValues().size())
     {
-        for (auto itr = dataElement->getChildList().cbegin();
-             itr != dataElement->getChildList().cend(); itr++)
-        {
-            if (((*itr)->getType() == CFDtokenType::FLOAT) ||
-                    ((*itr)->getType() == CFDtokenType::INT))
-            {
-                dataList.append((*itr)->getFloatVal());
-            }
-            else
-            {
-                currentDisplayError = "Data list does not contain floats";
-                delete dataRoot;
-                return false;
-            }
-        }
+        currentDisplayError = "Data file does not match mesh";
+        return false;
     }
-    else if (valueType == "magnitude")
-    {
-        for (auto itr = dataElement->getChildList().cbegin();
-             itr != dataElement->getChildList().cend(); itr++)
-        {
-            if ((*itr)->getType() != CFDtokenType::DATA_ARRAY)
-            {
-                currentDisplayError = "Data list does not contain float arrays";
-                delete dataRoot;
-                return false;
-            }
 
-            double sum = 0.0;
-            for (auto itr2 = (*itr)->getChildList().cbegin();
-                 itr2 != (*itr)->getChildList().cend(); itr2++)
-            {
-                double rawVal = (*itr2)->getFloatVal();
-                sum += rawVal * rawVal;
-            }
-            dataList.append(sqrt(sum));
-        }
-    }
-    else
-    {
-        currentDisplayError = "Invalid data type";
+    //Note: This shares the field's values, and does not copy them
+    dataList = theField->getValues();
+    myField = theField;
 
-        delete dataRoot;
-        return false;
-    }
+    lowDataVal = myField->getPercentile(clipPercentile);
+    highDataVal = myField->getPercentile(100.0 - clipPercentile);
 
-    QList<double> sortedList = dataList;
+    return true;
+}
 
-    std::sort(sortedList.begin(), sortedList.end());
+void CFDglCanvas::setClipPercentile(double percent)
+{
+    clipPercentile = qBound(0.0, percent, 50.0);
+    if (myField.isNull()) return;
 
-    if (sortedList.size() < 50)
-    {
-        lowDataVal = sortedList.at(0);
-        highDataVal = sortedList.last();
-    }
-    else
-    {
-        lowDataVal = sortedList.at(19);
-        highDataVal = sortedList.at(sortedList.size()-19);
-    }
+    //Only the shader's uniforms change, so the buffers are kept
+    lowDataVal = myField->getPercentile(clipPercentile);
+    highDataVal = myField->getPercentile(100.0 - clipPercentile);
+    this->update();
+}
 
-    delete dataRoot;
-    return true;
+double CFDglCanvas::getClipPercentile()
+{
+    return clipPercentile;
 }
 
 bool CFDglCanvas::displayAvailData()
 {
     if (!currentDisplayError.isEmpty()) return false;
-    if (pointList.isEmpty()) return false;
-    if (faceList.isEmpty()) return false;
+    if (pointCoords.isEmpty()) return false;
+    if (faceOffsets.size() < 2) return false;
     if (ownerList.isEmpty()) return false;
+
+    buildRenderData();
+    buffersStale = true;
+
     readyToDisplay = true;
     recomputePerspecMat();
     recomputeViewModelMat();
@@ -153,149 +171,281 @@ void CFDglCanvas::initializeGL()
 {
     initializeOpenGLFunctions();
     glClearColor(1.0f, 1.0f, 1.0f, 1.0f);
-}
 
-void CFDglCanvas::resizeGL(int w, int h)
-{
-    myDisplayWidth = w;
-    myDisplayHeight = h;
-    recomputePerspecMat();
+    //The context is remade if the widget changes windows.
+    //The context is already current here.
+    releaseGLObjects();
+    QObject::connect(context(), &QOpenGLContext::aboutToBeDestroyed,
+                     this, &CFDglCanvas::cleanupGL);
+
+    shaderProgram = new QOpenGLShaderProgram();
+    if (!shaderProgram->addShaderFromSourceCode(QOpenGLShader::Vertex, canvasVertexShader) ||
+            !shaderProgram->addShaderFromSourceCode(QOpenGLShader::Fragment, canvasFragmentShader) ||
+            !shaderProgram->link())
+    {
+        currentDisplayError = "Unable to set up display shaders";
+        readyToDisplay = false;
+        return;
+    }
+
+    lineVAO.create();
+    fillVAO.create();
+    pointBuffer.create();
+    lineIndexBuffer.create();
+    fillVertexBuffer.create();
+    fillIndexBuffer.create();
+
+    buffersStale = true;
 }
 
-bool CFDglCanvas::isAllZ0(QList<int> aFace)
+void CFDglCanvas::drawBuffers(const QMatrix4x4 &mvpMat)
 {
-    for (auto pointIndItr = aFace.cbegin(); pointIndItr != aFace.cend(); pointIndItr++)
+    if ((shaderProgram == nullptr) || !shaderProgram->isLinked()) return;
+    if (buffersStale) uploadBuffers();
+
+    shaderProgram->bind();
+    shaderProgram->setUniformValue("mvpMat", mvpMat);
+
+    if (fillIndexCount > 0)
     {
-        if (pointList.at(*pointIndItr).at(2) > PRECISION)
-        {
-            return false;
-        }
-        if (pointList.at(*pointIndItr).at(2) < -PRECISION)
-        {
-            return false;
-        }
+        shaderProgram->setUniformValue("useDataColor", static_cast<GLint>(1));
+        shaderProgram->setUniformValue("lowVal", static_cast<GLfloat>(lowDataVal));
+        shaderProgram->setUniformValue("highVal", static_cast<GLfloat>(highDataVal));
+
+        fillVAO.bind();
+        glDrawElements(GL_TRIANGLES, fillIndexCount, GL_UNSIGNED_INT, nullptr);
+        fillVAO.release();
     }
-    return true;
+
+    if (lineIndexCount > 0)
+    {
+        shaderProgram->setUniformValue("useDataColor", static_cast<GLint>(0));
+
+        lineVAO.bind();
+        glDrawElements(GL_LINES, lineIndexCount, GL_UNSIGNED_INT, nullptr);
+        lineVAO.release();
+    }
+
+    shaderProgram->release();
 }
 
-bool CFDglCanvas::loadRawMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile)
+void CFDglCanvas::buildEdgeIndices(const QVector<int> * faceSubset)
 {
-    clearAllData();
+    //First, each job takes a range of faces and splits their edges by hash
+    //into partitions, so every copy of an edge lands in the same partition.
+    //Then each partition is deduplicated by its own job.
 
-    CFDtoken * pointRoot = CFDtoken::lexifyString(rawPointFile);
-    CFDtoken * faceRoot = CFDtoken::lexifyString(rawFaceFile);
-    CFDtoken * ownerRoot = CFDtoken::lexifyString(rawOwnerFile);
+    lineIndices.clear();
 
-    if (!CFDtoken::parseTokenStream(pointRoot) ||
-        !CFDtoken::parseTokenStream(faceRoot) ||
-        !CFDtoken::parseTokenStream(ownerRoot))
+    int faceCount = (faceSubset == nullptr) ? getFaceCount() : faceSubset->size();
+    if (faceCount == 0) return;
+
+    int jobCount = 1;
+    if (faceCount >= CFD_EDGE_PARALLEL_MIN_FACES)
     {
-        currentDisplayError = "Unable to read mesh data files";
-        delete pointRoot;
-        delete faceRoot;
-        delete ownerRoot;
-        return false;
+        jobCount = qMax(1, QThread::idealThreadCount());
+    }
+
+    QVector<EdgeGatherJob> gatherJobs;
+    for (int i = 0; i < jobCount; i++)
+    {
+        EdgeGatherJob aJob;
+        aJob.offsets = faceOffsets.constData();
+        aJob.indices = faceIndices.constData();
+        aJob.faceSubset = (faceSubset == nullptr) ? nullptr : faceSubset->constData();
+        aJob.firstFace = static_cast<int>((static_cast<qint64>(faceCount) * i) / jobCount);
+        aJob.lastFace = static_cast<int>((static_cast<qint64>(faceCount) * (i + 1)) / jobCount);
+        aJob.partEdges.resize(jobCount);
+        gatherJobs.append(aJob);
     }
 
-    CFDtoken * pointElement = pointRoot->getLargestChildArray();
-    CFDtoken * faceElement = faceRoot->getLargestChildArray();
-    CFDtoken * ownerElement = ownerRoot->getLargestChildArray();
+    QVector<EdgeMergeJob> mergeJobs;
+    for (int i = 0; i < jobCount; i++)
+    {
+        EdgeMergeJob aJob;
+        aJob.partition = i;
+        aJob.gatherJobs = &gatherJobs;
+        mergeJobs.append(aJob);
+    }
 
-    if ((pointElement == nullptr) || (faceElement == nullptr) || (ownerElement == nullptr))
+    if (jobCount == 1)
     {
-        currentDisplayError = "Unable to locate mesh data in files";
-        delete pointRoot;
-        delete faceRoot;
-        delete ownerRoot;
-        return false;
+        gatherEdges(gatherJobs[0]);
+        mergeEdges(mergeJobs[0]);
+    }
+    else
+    {
+        QtConcurrent::blockingMap(gatherJobs, &CFDglCanvas::gatherEdges);
+        QtConcurrent::blockingMap(mergeJobs, &CFDglCanvas::mergeEdges);
+    }
+    gatherJobs.clear();
+
+    int edgeCount = 0;
+    for (const EdgeMergeJob &aJob : mergeJobs)
+    {
+        edgeCount += aJob.uniqueEdges.size();
     }
 
-    //TODO: Add more validity checks before reading each element
-    for (auto itr = pointElement->getChildList().cbegin();
-         itr != pointElement->getChildList().cend(); itr++)
+    lineIndices.reserve(2 * edgeCount);
+    for (const EdgeMergeJob &aJob : mergeJobs)
     {
-        if ((*itr)->getChildSize() != 3)
+        for (quint64 anEdge : aJob.uniqueEdges)
         {
-            currentDisplayError = "Point list does not contain points";
-            delete pointRoot; delete faceRoot; delete ownerRoot;
-            return false;
+            lineIndices.append(static_cast<GLuint>(anEdge >> 32));
+            lineIndices.append(static_cast<GLuint>(anEdge & 0xFFFFFFFFu));
         }
-        QList<double> aPoint;
+    }
+}
 
-        for (auto coordItr = (*itr)->getChildList().cbegin();
-             coordItr != (*itr)->getChildList().cend(); coordItr++)
+void CFDglCanvas::gatherEdges(EdgeGatherJob &theJob)
+{
+    //Note: This may run on a worker thread. It only writes its own job.
+    int partCount = theJob.partEdges.size();
+
+    for (int i = theJob.firstFace; i < theJob.lastFace; i++)
+    {
+        int faceIndex = (theJob.faceSubset == nullptr) ? i : theJob.faceSubset[i];
+        int faceStart = theJob.offsets[faceIndex];
+        int faceEnd = theJob.offsets[faceIndex + 1];
+
+        quint32 prevPoint = static_cast<quint32>(theJob.indices[faceEnd - 1]);
+        for (int ind = faceStart; ind < faceEnd; ind++)
         {
-            if ((*coordItr)->getType() == CFDtokenType::INT)
-            {
-                double tmp = static_cast<double> ((*coordItr)->getIntVal());
-                aPoint.append(tmp);
-            }
-            else if ((*coordItr)->getType() == CFDtokenType::FLOAT)
-            {
-                aPoint.append((*coordItr)->getFloatVal());
-            }
-            else
+            quint32 thisPoint = static_cast<quint32>(theJob.indices[ind]);
+
+            //An edge is keyed by its lower point, then its higher point
+            quint64 edgeKey = (prevPoint < thisPoint) ?
+                        ((static_cast<quint64>(prevPoint) << 32) | thisPoint) :
+                        ((static_cast<quint64>(thisPoint) << 32) | prevPoint);
+            prevPoint = thisPoint;
+
+            int partition = 0;
+            if (partCount > 1)
             {
-                currentDisplayError = "Point list does not contain numbers";
-                delete pointRoot; delete faceRoot; delete ownerRoot;
-                return false;
+                partition = static_cast<int>(((edgeKey * Q_UINT64_C(0x9E3779B97F4A7C15)) >> 32) % static_cast<quint64>(partCount));
             }
+            theJob.partEdges[partition].append(edgeKey);
         }
+    }
+}
 
-        pointList.append(aPoint);
+void CFDglCanvas::mergeEdges(EdgeMergeJob &theJob)
+{
+    //Note: This may run on a worker thread. It only writes its own job.
+    int edgeCount = 0;
+    for (const EdgeGatherJob &aGather : *theJob.gatherJobs)
+    {
+        edgeCount += aGather.partEdges.at(theJob.partition).size();
     }
 
-    for (auto itr = faceElement->getChildList().cbegin();
-         itr != faceElement->getChildList().cend(); itr++)
+    theJob.uniqueEdges.reserve(edgeCount);
+    for (const EdgeGatherJob &aGather : *theJob.gatherJobs)
     {
-        QList<int> aFace;
+        theJob.uniqueEdges += aGather.partEdges.at(theJob.partition);
+    }
 
-        for (auto elementItr = (*itr)->getChildList().cbegin();
-             elementItr != (*itr)->getChildList().cend(); elementItr++)
-        {
-            if ((*elementItr)->getType() == CFDtokenType::INT)
-            {
-                aFace.append((*elementItr)->getIntVal());
-            }
-            else
-            {
-                currentDisplayError = "Face list does not contain ints";
-                delete pointRoot; delete faceRoot; delete ownerRoot;
-                return false;
-            }
-        }
+    std::sort(theJob.uniqueEdges.begin(), theJob.uniqueEdges.end());
+    theJob.uniqueEdges.erase(std::unique(theJob.uniqueEdges.begin(), theJob.uniqueEdges.end()),
+                             theJob.uniqueEdges.end());
+}
 
-        faceList.append(aFace);
+void CFDglCanvas::uploadBuffers()
+{
+    //Note: Called with the context current, from paintGL
+    buffersStale = false;
+
+    lineVAO.bind();
+    pointBuffer.bind();
+    pointBuffer.allocate(pointCoords.constData(), pointCoords.size() * static_cast<int>(sizeof(GLfloat)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(GLfloat), nullptr);
+    lineIndexBuffer.bind();
+    lineIndexBuffer.allocate(lineIndices.constData(), lineIndices.size() * static_cast<int>(sizeof(GLuint)));
+    lineVAO.release();
+    pointBuffer.release();
+
+    fillVAO.bind();
+    fillVertexBuffer.bind();
+    fillVertexBuffer.allocate(fillVertices.constData(), fillVertices.size() * static_cast<int>(sizeof(GLfloat)));
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat), nullptr);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 1, GL_FLOAT, GL_FALSE, 4 * sizeof(GLfloat),
+                          reinterpret_cast<const void *>(3 * sizeof(GLfloat)));
+    fillIndexBuffer.bind();
+    fillIndexBuffer.allocate(fillIndices.constData(), fillIndices.size() * static_cast<int>(sizeof(GLuint)));
+    fillVAO.release();
+    fillVertexBuffer.release();
+
+    lineIndexCount = lineIndices.size();
+    fillIndexCount = fillIndices.size();
+}
+
+void CFDglCanvas::cleanupGL()
+{
+    //GL objects can only be freed with their context current
+    makeCurrent();
+    releaseGLObjects();
+    doneCurrent();
+}
+
+void CFDglCanvas::releaseGLObjects()
+{
+    if (shaderProgram != nullptr)
+    {
+        delete shaderProgram;
+        shaderProgram = nullptr;
     }
 
-    for (auto itr = ownerElement->getChildList().cbegin();
-         itr != ownerElement->getChildList().cend(); itr++)
+    lineVAO.destroy();
+    fillVAO.destroy();
+    pointBuffer.destroy();
+    lineIndexBuffer.destroy();
+    fillVertexBuffer.destroy();
+    fillIndexBuffer.destroy();
+
+    buffersStale = true;
+}
+
+void CFDglCanvas::resizeGL(int w, int h)
+{
+    myDisplayWidth = w;
+    myDisplayHeight = h;
+    recomputePerspecMat();
+}
+
+bool CFDglCanvas::installMeshData(QSharedPointer<const CFDmeshData> theMesh)
+{
+    clearAllData();
+
+    if (theMesh.isNull() || !theMesh->getError().isEmpty() ||
+            (theMesh->getPointCount() == 0) || (theMesh->getFaceCount() == 0))
     {
-        if ((*itr)->getType() == CFDtokenType::INT)
-        {
-            ownerList.append((*itr)->getIntVal());
-        }
-        else
-        {
-            currentDisplayError = "Owner list does not contain ints";
-            delete pointRoot; delete faceRoot; delete ownerRoot;
-            return false;
-        }
+        currentDisplayError = "Unable to read mesh data files";
+        return false;
     }
 
-    delete pointRoot;
-    delete faceRoot;
-    delete ownerRoot;
+    //Note: The face and owner arrays are shared with the mesh, and not copied
+    faceOffsets = theMesh->getFaceOffsets();
+    faceIndices = theMesh->getFaceIndices();
+    ownerList = theMesh->getOwners();
+
+    const QVector<double> &meshCoords = theMesh->getPointCoords();
+    pointCoords.resize(meshCoords.size());
+    for (int i = 0; i < meshCoords.size(); i++)
+    {
+        pointCoords[i] = static_cast<GLfloat>(meshCoords.at(i));
+    }
 
-    modelBounds2D.setBottom(pointList.at(0).at(1));
-    modelBounds2D.setTop(pointList.at(0).at(1));
-    modelBounds2D.setLeft(pointList.at(0).at(0));
-    modelBounds2D.setRight(pointList.at(0).at(0));
+    modelBounds2D.setBottom(meshCoords.at(1));
+    modelBounds2D.setTop(meshCoords.at(1));
+    modelBounds2D.setLeft(meshCoords.at(0));
+    modelBounds2D.setRight(meshCoords.at(0));
 
-    for (auto itr = pointList.cbegin(); itr != pointList.cend(); itr++)
+    for (int i = 0; i + 2 < meshCoords.size(); i += 3)
     {
-        double xVal = (*itr).at(0);
-        double yVal = (*itr).at(1);
+        double xVal = meshCoords.at(i);
+        double yVal = meshCoords.at(i + 1);
 
         if (xVal < modelBounds2D.left()) modelBounds2D.setLeft(xVal);
         if (xVal > modelBounds2D.right()) modelBounds2D.setRight(xVal);
@@ -310,9 +460,21 @@ void CFDglCanvas::clearAllData()
 {
     currentDisplayError.clear();
 
-    pointList.clear();
-    faceList.clear();
+    pointCoords.clear();
+    faceOffsets.clear();
+    faceIndices.clear();
     ownerList.clear();
 
     dataList.clear();
+    myField.clear();
+
+    lineIndices.clear();
+    fillVertices.clear();
+    fillIndices.clear();
+}
+
+int CFDglCanvas::getFaceCount()
+{
+    if (faceOffsets.isEmpty()) return 0;
+    return faceOffsets.size() - 1;
 }
@@ -38,11 +38,26 @@
 
 #include <QOpenGLWidget>
 #include <QOpenGLFunctions>
+#include <QOpenGLBuffer>
+#include <QOpenGLVertexArrayObject>
+#include <QOpenGLShaderProgram>
 #include <QMouseEvent>
 
 #include <QMatrix4x4>
 
 #include <QtMath>
+#include <QSharedPointer>
+#include <QVector>
+
+#include "cfdmeshdata.h"
+
+//Note: Geometry is built into vertex and index buffers once, when data is
+//displayed. paintGL then only sets the view matrix and issues draw calls.
+//This needs a 3.3 core profile context.
+
+//Wireframes draw each shared edge once. Meshes with this many faces
+//find their unique edges on all cores.
+#define CFD_EDGE_PARALLEL_MIN_FACES 65536
 
 class CFDglCanvas : public QOpenGLWidget, protected QOpenGLFunctions
 {
@@ -50,8 +65,12 @@ public:
     CFDglCanvas(QWidget *parent = Q_NULLPTR, Qt::WindowFlags f = Qt::WindowFlags());
     ~CFDglCanvas();
 
-    virtual bool loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile) = 0;
-    bool loadFieldData(QByteArray * rawDataFile, QString valueType);
+    virtual bool loadMeshData(QSharedPointer<const CFDmeshData> theMesh) = 0;
+    bool loadFieldData(QSharedPointer<const CFDfieldData> theField);
+
+    //The color scale runs from this percentile of the field to (100 - this)
+    void setClipPercentile(double percent);
+    double getClipPercentile();
 
     bool displayAvailData();
     QString getDisplayError();
@@ -60,14 +79,30 @@ protected:
     virtual void initializeGL();
     virtual void resizeGL(int w, int h);
 
-    bool isAllZ0(QList<int> aFace);
-    bool loadRawMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile);
+    virtual void buildRenderData() = 0;
+    void drawBuffers(const QMatrix4x4 &mvpMat);
+    //Fills lineIndices with each edge once. Null faceSubset means all faces.
+    void buildEdgeIndices(const QVector<int> * faceSubset);
+
+    bool installMeshData(QSharedPointer<const CFDmeshData> theMesh);
     void clearAllData();
 
-    QList<QList<double>> pointList;
-    QList<QList<int>> faceList;
-    QList<int> ownerList;
-    QList<double> dataList;
+    int getFaceCount();
+
+    //Points are packed x,y,z floats, as they are given to GL
+    QVector<GLfloat> pointCoords;
+    //Face i is faceIndices[faceOffsets[i]] to faceIndices[faceOffsets[i+1] - 1]
+    QVector<int> faceOffsets;
+    QVector<int> faceIndices;
+    QVector<int> ownerList;
+    QVector<double> dataList;
+
+    //Filled in by buildRenderData:
+    //Line indices refer to pointCoords
+    QVector<GLuint> lineIndices;
+    //Fill vertices are x,y,z,value, and each face has its own vertices
+    QVector<GLfloat> fillVertices;
+    QVector<GLuint> fillIndices;
 
     bool readyToDisplay = false;
     QString currentDisplayError;
@@ -77,12 +112,48 @@ protected:
     int myDisplayHeight;
     double lowDataVal;
     double highDataVal;
-
-    constexpr static const double PRECISION = 0.000000001;
+    double clipPercentile = 0.1;
+    QSharedPointer<const CFDfieldData> myField;
 
 private:
     virtual void recomputePerspecMat() = 0;
     virtual void recomputeViewModelMat() = 0;
+
+    struct EdgeGatherJob
+    {
+        const int * offsets;
+        const int * indices;
+        const int * faceSubset;
+        int firstFace;
+        int lastFace;
+        QVector<QVector<quint64>> partEdges;
+    };
+
+    struct EdgeMergeJob
+    {
+        int partition;
+        const QVector<EdgeGatherJob> * gatherJobs;
+        QVector<quint64> uniqueEdges;
+    };
+
+    static void gatherEdges(EdgeGatherJob &theJob);
+    static void mergeEdges(EdgeMergeJob &theJob);
+
+    void uploadBuffers();
+    void cleanupGL();
+    void releaseGLObjects();
+
+    QOpenGLShaderProgram * shaderProgram = nullptr;
+    QOpenGLVertexArrayObject lineVAO;
+    QOpenGLVertexArrayObject fillVAO;
+    QOpenGLBuffer pointBuffer;
+    QOpenGLBuffer lineIndexBuffer;
+    QOpenGLBuffer fillVertexBuffer;
+    QOpenGLBuffer fillIndexBuffer;
+
+    bool buffersStale = true;
+    int lineIndexCount = 0;
+    int fillIndexCount = 0;
 };
 
 #endif // CFDGLCANVAS_H
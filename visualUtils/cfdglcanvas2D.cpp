@@ -39,9 +39,43 @@ CFDglCanvas2D::CFDglCanvas2D(QWidget *parent, Qt::WindowFlags f) : CFDglCanvas(p
 
 CFDglCanvas2D::~CFDglCanvas2D() {}
 
-bool CFDglCanvas2D::loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile)
+bool CFDglCanvas2D::loadMeshData(QSharedPointer<const CFDmeshData> theMesh)
 {
-    return loadRawMeshData(rawPointFile, rawFaceFile, rawOwnerFile);
+    frontFaces.clear();
+    myMesh.clear();
+
+    if (!installMeshData(theMesh)) return false;
+
+    //The front plane is the end of the mesh's z extent nearest z = 0,
+    //which is z = 0 itself for meshes built on it
+    const QVector<double> &meshCoords = theMesh->getPointCoords();
+    double highz = meshCoords.at(2);
+    double lowz = meshCoords.at(2);
+    for (int i = 2; i < meshCoords.size(); i += 3)
+    {
+        double zVal = meshCoords.at(i);
+
+        if (zVal > highz) highz = zVal;
+        if (zVal < lowz) lowz = zVal;
+    }
+
+    myMesh = theMesh;
+    setFrontPlane((qAbs(highz) < qAbs(lowz)) ? highz : lowz, frontPlaneTolerance);
+    return true;
+}
+
+void CFDglCanvas2D::setFrontPlane(double zValue, double tolerance)
+{
+    frontPlaneZ = zValue;
+    frontPlaneTolerance = tolerance;
+
+    if (myMesh.isNull()) return;
+
+    findFrontFaces();
+    if (readyToDisplay)
+    {
+        displayAvailData();
+    }
 }
 
 void CFDglCanvas2D::mousePressEvent(QMouseEvent *event)
@@ -93,92 +127,83 @@ void CFDglCanvas2D::wheelEvent(QWheelEvent *event)
 
 void CFDglCanvas2D::paintGL()
 {
+    glClear(GL_COLOR_BUFFER_BIT);
     if (!readyToDisplay) return;
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glLoadMatrixf(projMat.data());
+    drawBuffers(projMat * viewModelMat);
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glLoadMatrixf(viewModelMat.data());
+void CFDglCanvas2D::buildRenderData()
+{
+    //Only the faces on the front plane are shown.
+    //With no field data, these are drawn as outlines.
+    //With field data, each face is filled with its cell's value.
 
-    glClear(GL_COLOR_BUFFER_BIT);
+    lineIndices.clear();
+    fillVertices.clear();
+    fillIndices.clear();
 
     if (dataList.isEmpty())
     {
-        glColor3f(0.0, 0.0, 0.0);
-        glBegin(GL_LINES);
+        buildEdgeIndices(&frontFaces);
+        return;
+    }
+
+    for (int faceIndex : frontFaces)
+    {
+        int faceStart = faceOffsets.at(faceIndex);
+        int faceEnd = faceOffsets.at(faceIndex + 1);
 
-        for (auto faceItr = faceList.cbegin(); faceItr != faceList.cend(); faceItr++)
+        GLfloat faceVal = static_cast<GLfloat>(dataList.at(ownerList.at(faceIndex)));
+
+        //Each face gets its own vertices, so that it has one flat color
+        GLuint firstVertex = static_cast<GLuint>(fillVertices.size() / 4);
+        for (int ind = faceStart; ind < faceEnd; ind++)
         {
-            QList<int> aFace = (*faceItr);
-            bool allZ0 = isAllZ0(aFace);
-
-            if (allZ0)
-            {
-                glVertex3f(static_cast<GLfloat>(pointList.at(aFace.last()).at(0)),
-                           static_cast<GLfloat>(pointList.at(aFace.last()).at(1)),0.0);
-                glVertex3f(static_cast<GLfloat>(pointList.at(aFace.first()).at(0)),
-                           static_cast<GLfloat>(pointList.at(aFace.first()).at(1)),0.0);
-
-                for (int ind = 1; ind < aFace.size(); ind++)
-                {
-                    glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(0)),
-                               static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(1)),0.0);
-                    glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(0)),
-                               static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(1)),0.0);
-                }
-            }
+            int thisPoint = faceIndices.at(ind);
+            fillVertices.append(pointCoords.at(3 * thisPoint));
+            fillVertices.append(pointCoords.at(3 * thisPoint + 1));
+            fillVertices.append(pointCoords.at(3 * thisPoint + 2));
+            fillVertices.append(faceVal);
+        }
+
+        //Faces are convex, and split into a fan of triangles
+        GLuint faceSize = static_cast<GLuint>(faceEnd - faceStart);
+        for (GLuint ind = 1; ind + 1 < faceSize; ind++)
+        {
+            fillIndices.append(firstVertex);
+            fillIndices.append(firstVertex + ind);
+            fillIndices.append(firstVertex + ind + 1);
         }
-        glEnd();
-        return;
     }
+}
 
-    int indexVal = -1;
-    for (auto faceItr = faceList.cbegin(); faceItr != faceList.cend(); faceItr++)
+void CFDglCanvas2D::findFrontFaces()
+{
+    //The faces drawn are found once per mesh, from the full precision points
+    frontFaces.clear();
+
+    const QVector<double> &meshCoords = myMesh->getPointCoords();
+    for (int faceIndex = 0; faceIndex < getFaceCount(); faceIndex++)
     {
-        indexVal++;
-        QList<int> aFace = (*faceItr);
-        bool allZ0 = isAllZ0(aFace);
+        if (isOnFrontPlane(meshCoords, faceIndex))
+        {
+            frontFaces.append(faceIndex);
+        }
+    }
+}
 
-        if (allZ0)
+bool CFDglCanvas2D::isOnFrontPlane(const QVector<double> &meshCoords, int faceIndex)
+{
+    for (int i = faceOffsets.at(faceIndex); i < faceOffsets.at(faceIndex + 1); i++)
+    {
+        double zDist = meshCoords.at(3 * faceIndices.at(i) + 2) - frontPlaneZ;
+        if ((zDist > frontPlaneTolerance) || (zDist < -frontPlaneTolerance))
         {
-            double rawData = dataList.at(ownerList.at(indexVal)); //TODO: Probably should check bounds
-
-            double dataVal = (rawData - lowDataVal) / (highDataVal - lowDataVal);
-
-            glBegin(GL_POLYGON);
-            double redVal = 1.0;
-            double greenVal = 0.0;
-            double blueVal = 1.0;
-
-            if (dataVal > 1.0) dataVal = 1.0;
-            else if (dataVal < 0.0) dataVal = 0.0;
-
-            if (dataVal > 0.5)
-            {
-                blueVal = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);
-                greenVal = 0.3 + 0.7 * ((1.0 - dataVal) / 0.5);
-            }
-            else
-            {
-                redVal = 0.3 + 0.7 * (dataVal / 0.5);
-                greenVal = 0.3 + 0.7 * (dataVal / 0.5);
-            }
-
-            glColor3f(static_cast<GLfloat>(redVal),
-                      static_cast<GLfloat>(greenVal),
-                      static_cast<GLfloat>(blueVal));
-
-            for (int ind = 0; ind < aFace.size(); ind++)
-            {
-                glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(0)),
-                           static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(1)),0.0);
-            }
-            glEnd();
+            return false;
         }
     }
+    return true;
 }
 
 void CFDglCanvas2D::recomputePerspecMat()
@@ -225,7 +250,9 @@ void CFDglCanvas2D::recomputeViewModelMat()
 {
     viewModelMat.setToIdentity();
 
+    //The front plane is moved to z = 0, inside the -1 to 1 depth of the projection
     viewModelMat.translate(panXdist, panYdist);
     viewModelMat.translate(static_cast<float>(-modelBounds2D.center().x()),
-                           static_cast<float>(-modelBounds2D.center().y()));
+                           static_cast<float>(-modelBounds2D.center().y()),
+                           static_cast<float>(-frontPlaneZ));
 }
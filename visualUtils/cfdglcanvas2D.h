@@ -44,7 +44,11 @@ public:
     CFDglCanvas2D(QWidget *parent = Q_NULLPTR, Qt::WindowFlags f = Qt::WindowFlags());
     ~CFDglCanvas2D();
 
-    bool loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile);
+    bool loadMeshData(QSharedPointer<const CFDmeshData> theMesh);
+
+    //Only faces with every point within tolerance of the plane z = zValue are drawn.
+    //Loading a mesh sets this to the end of its z extent nearest z = 0.
+    void setFrontPlane(double zValue, double tolerance);
 
 protected:
     virtual void mousePressEvent(QMouseEvent *event);
@@ -53,6 +57,7 @@ protected:
     virtual void wheelEvent(QWheelEvent *event);
 
     virtual void paintGL();
+    virtual void buildRenderData();
 
 private:
     constexpr static const double ZOOMFACTOR2D = 650.0;
@@ -60,6 +65,14 @@ private:
     virtual void recomputePerspecMat();
     virtual void recomputeViewModelMat();
 
+    void findFrontFaces();
+    bool isOnFrontPlane(const QVector<double> &meshCoords, int faceIndex);
+
+    QSharedPointer<const CFDmeshData> myMesh;
+    QVector<int> frontFaces;
+    double frontPlaneZ = 0.0;
+    double frontPlaneTolerance = 0.000000001;
+
     QMatrix4x4 projMat;
     QMatrix4x4 viewModelMat;
 
@@ -39,16 +39,21 @@ CFDglCanvas3D::CFDglCanvas3D(QWidget *parent, Qt::WindowFlags f) : CFDglCanvas(p
 
 CFDglCanvas3D::~CFDglCanvas3D() {}
 
-bool CFDglCanvas3D::loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile)
+bool CFDglCanvas3D::loadMeshData(QSharedPointer<const CFDmeshData> theMesh)
 {
-    if (!loadRawMeshData(rawPointFile, rawFaceFile, rawOwnerFile)) return false;
+    patchList.clear();
+    shownFaces.clear();
 
-    double highz = pointList.at(0).at(2);
-    double lowz = pointList.at(0).at(2);
+    if (!installMeshData(theMesh)) return false;
 
-    for (auto itr = pointList.cbegin(); itr != pointList.cend(); itr++)
+    patchList = theMesh->getPatches();
+
+    double highz = pointCoords.at(2);
+    double lowz = pointCoords.at(2);
+
+    for (int i = 2; i < pointCoords.size(); i += 3)
     {
-        double zVal = (*itr).at(2);
+        double zVal = pointCoords.at(i);
 
         if (zVal > highz) highz = zVal;
         if (zVal < lowz) lowz = zVal;
@@ -61,43 +66,64 @@ bool CFDglCanvas3D::loadMeshData(QByteArray * rawPointFile, QByteArray * rawFace
 
 void CFDglCanvas3D::paintGL()
 {
+    glClear(GL_COLOR_BUFFER_BIT);
     if (!readyToDisplay) return;
 
-    glMatrixMode(GL_PROJECTION);
-    glLoadIdentity();
-    glLoadMatrixf(projMat.data());
+    drawBuffers(projMat * viewModelMat);
+}
 
-    glMatrixMode(GL_MODELVIEW);
-    glLoadIdentity();
-    glLoadMatrixf(viewModelMat.data());
+QStringList CFDglCanvas3D::getPatchNames()
+{
+    QStringList ret;
+    for (const CFDmeshPatch &aPatch : patchList)
+    {
+        ret.append(aPatch.name);
+    }
+    return ret;
+}
 
-    glClear(GL_COLOR_BUFFER_BIT);
+bool CFDglCanvas3D::patchIsVisible(QString patchName)
+{
+    return !hiddenPatches.contains(patchName);
+}
 
-    glColor3f(0.0, 0.0, 0.0);
-    glBegin(GL_LINES);
+void CFDglCanvas3D::setPatchVisible(QString patchName, bool visible)
+{
+    if (visible == patchIsVisible(patchName)) return;
+
+    if (visible) hiddenPatches.remove(patchName);
+    else hiddenPatches.insert(patchName);
 
-    for (auto faceItr = faceList.cbegin(); faceItr != faceList.cend(); faceItr++)
+    if (readyToDisplay)
     {
-        QList<int> aFace = (*faceItr);
+        displayAvailData();
+    }
+}
+
+void CFDglCanvas3D::buildRenderData()
+{
+    //Faces are drawn as outlines, with shared edges drawn once.
+    //With a boundary, only the faces of shown patches are drawn.
+    fillVertices.clear();
+    fillIndices.clear();
 
-        glVertex3f(static_cast<GLfloat>(pointList.at(aFace.last()).at(0)),
-                   static_cast<GLfloat>(pointList.at(aFace.last()).at(1)),
-                   static_cast<GLfloat>(pointList.at(aFace.last()).at(2)));
-        glVertex3f(static_cast<GLfloat>(pointList.at(aFace.first()).at(0)),
-                   static_cast<GLfloat>(pointList.at(aFace.first()).at(1)),
-                   static_cast<GLfloat>(pointList.at(aFace.first()).at(2)));
+    if (patchList.isEmpty())
+    {
+        buildEdgeIndices(nullptr);
+        return;
+    }
 
-        for (int ind = 1; ind < aFace.size(); ind++)
+    shownFaces.clear();
+    for (const CFDmeshPatch &aPatch : patchList)
+    {
+        if (hiddenPatches.contains(aPatch.name)) continue;
+        for (int i = aPatch.startFace; i < aPatch.startFace + aPatch.faceCount; i++)
         {
-            glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(0)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(1)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind - 1)).at(2)));
-            glVertex3f(static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(0)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(1)),
-                       static_cast<GLfloat>(pointList.at(aFace.at(ind)).at(2)));
+            shownFaces.append(i);
         }
     }
-    glEnd();
+
+    buildEdgeIndices(&shownFaces);
 }
 
 void CFDglCanvas3D::recomputePerspecMat()
@@ -38,13 +38,22 @@
 
 #include "cfdglcanvas.h"
 
+#include <QSet>
+#include <QStringList>
+
 class CFDglCanvas3D : public CFDglCanvas
 {
 public:
     CFDglCanvas3D(QWidget *parent = Q_NULLPTR, Qt::WindowFlags f = Qt::WindowFlags());
     ~CFDglCanvas3D();
 
-    bool loadMeshData(QByteArray * rawPointFile, QByteArray * rawFaceFile, QByteArray * rawOwnerFile);
+    bool loadMeshData(QSharedPointer<const CFDmeshData> theMesh);
+
+    //A mesh with boundary patches holds only patch faces,
+    //and each patch can be hidden by name
+    QStringList getPatchNames();
+    bool patchIsVisible(QString patchName);
+    void setPatchVisible(QString patchName, bool visible);
 
 protected:
     //virtual void mousePressEvent(QMouseEvent *event);
@@ -53,6 +62,7 @@ protected:
     //virtual void wheelEvent(QWheelEvent *event);
 
     virtual void paintGL();
+    virtual void buildRenderData();
 
 private:
     virtual void recomputePerspecMat();
@@ -61,6 +71,10 @@ private:
     QMatrix4x4 projMat;
     QMatrix4x4 viewModelMat;
 
+    QVector<CFDmeshPatch> patchList;
+    QSet<QString> hiddenPatches;
+    QVector<int> shownFaces;
+
     double centerz;
 };
 
@@ -0,0 +1,905 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdlistscanner.h"
+#include "cfdnumberscanner.h"
+
+#include <QtEndian>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <cctype>
+#include <cstring>
+#include <limits>
+
+CFDlistScanner::CFDlistScanner(const QByteArray * rawInput)
+{
+    myPos = rawInput->constData();
+    myEnd = myPos + rawInput->size();
+}
+
+CFDlistScanner::CFDlistScanner(const char * rangeStart, const char * rangeEnd)
+{
+    myPos = rangeStart;
+    myEnd = rangeEnd;
+}
+
+bool CFDlistScanner::seekDataList()
+{
+    //Finds the first top-level list of the form: N ( ...
+    //and leaves the scanner just inside the opening paren
+
+    bool lastWordWasInt = false;
+    bool lastWordWasHeader = false;
+    int lastInt = -1;
+
+    while (true)
+    {
+        skipSpaceAndComments();
+        if (myPos == myEnd) return false;
+
+        char aLetter = *myPos;
+
+        if (aLetter == '{')
+        {
+            if (lastWordWasHeader)
+            {
+                if (!readFoamHeader()) return false;
+            }
+            else if (!skipEnclosed('{','}'))
+            {
+                return false;
+            }
+            lastWordWasInt = false;
+            lastWordWasHeader = false;
+        }
+        else if (aLetter == '(')
+        {
+            if (lastWordWasInt)
+            {
+                myPos++;
+                listSize = lastInt;
+                return true;
+            }
+            if (!skipEnclosed('(',')')) return false;
+            lastWordWasInt = false;
+            lastWordWasHeader = false;
+        }
+        else if (aLetter == '"')
+        {
+            skipQuotedString();
+            lastWordWasInt = false;
+            lastWordWasHeader = false;
+        }
+        else if ((aLetter == ';') || (aLetter == ')') || (aLetter == '}'))
+        {
+            myPos++;
+            lastWordWasInt = false;
+            lastWordWasHeader = false;
+        }
+        else
+        {
+            const char * wordStart;
+            readWord(&wordStart);
+            lastWordWasHeader = (QByteArray::fromRawData(wordStart, static_cast<int>(myPos - wordStart)) == "FoamFile");
+
+            lastWordWasInt = true;
+            lastInt = 0;
+            for (const char * digitPtr = wordStart; digitPtr != myPos; digitPtr++)
+            {
+                int digitVal = *digitPtr - '0';
+                //A word too long for an int is not a list size
+                if (!std::isdigit(static_cast<unsigned char>(*digitPtr)) ||
+                        (lastInt > (std::numeric_limits<int>::max() - digitVal) / 10))
+                {
+                    lastWordWasInt = false;
+                    break;
+                }
+                lastInt = lastInt * 10 + digitVal;
+            }
+        }
+    }
+}
+
+int CFDlistScanner::getListSize()
+{
+    return listSize;
+}
+
+void CFDlistScanner::setChunkedReading(bool allowChunks)
+{
+    chunksAllowed = allowChunks;
+}
+
+bool CFDlistScanner::lastReadWasChunked()
+{
+    return readInChunks;
+}
+
+bool CFDlistScanner::readVectors(int width, QVector<double> * output)
+{
+    if (listSize < 0) return false;
+
+    output->clear();
+
+    if (binaryFormat)
+    {
+        qint64 valueCount = static_cast<qint64>(listSize) * width;
+        if (valueCount > std::numeric_limits<int>::max()) return false;
+        if (!readRawScalars(static_cast<int>(valueCount), output)) return false;
+        return expectChar(')');
+    }
+
+    if (readChunked(ListRecord::VECTOR, width, output, nullptr, nullptr))
+    {
+        return expectChar(')');
+    }
+
+    //Each ascii value takes at least a digit and a separator
+    output->reserve(reserveLimit(static_cast<qint64>(listSize) * width, 2));
+
+    for (int i = 0; i < listSize; i++)
+    {
+        if (!expectChar('(')) return false;
+        for (int j = 0; j < width; j++)
+        {
+            double aVal;
+            if (!readDouble(&aVal)) return false;
+            output->append(aVal);
+        }
+        if (!expectChar(')')) return false;
+    }
+
+    return expectChar(')');
+}
+
+bool CFDlistScanner::readScalars(QVector<double> * output)
+{
+    if (listSize < 0) return false;
+
+    output->clear();
+
+    if (binaryFormat)
+    {
+        if (!readRawScalars(listSize, output)) return false;
+        return expectChar(')');
+    }
+
+    if (readChunked(ListRecord::SCALAR, 1, output, nullptr, nullptr))
+    {
+        return expectChar(')');
+    }
+
+    output->reserve(reserveLimit(listSize, 2));
+
+    for (int i = 0; i < listSize; i++)
+    {
+        double aVal;
+        if (!readDouble(&aVal)) return false;
+        output->append(aVal);
+    }
+
+    return expectChar(')');
+}
+
+bool CFDlistScanner::readLabels(QVector<int> * output)
+{
+    if (listSize < 0) return false;
+
+    output->clear();
+
+    if (binaryFormat)
+    {
+        if (!readRawLabels(listSize, output)) return false;
+        return expectChar(')');
+    }
+
+    if (readChunked(ListRecord::LABEL, 1, nullptr, output, nullptr))
+    {
+        return expectChar(')');
+    }
+
+    output->reserve(reserveLimit(listSize, 2));
+
+    for (int i = 0; i < listSize; i++)
+    {
+        int aVal;
+        if (!readInt(&aVal)) return false;
+        output->append(aVal);
+    }
+
+    return expectChar(')');
+}
+
+bool CFDlistScanner::readFaces(QVector<int> * faceOffsets, QVector<int> * faceIndices)
+{
+    if (listSize < 0) return false;
+
+    faceOffsets->clear();
+    faceIndices->clear();
+
+    if (headerClass == "faceCompactList")
+    {
+        //Compact faces are two lists: offsets (one more than the face count)
+        //and then all of the point indexes
+        if (!readLabels(faceOffsets)) return false;
+        if (!seekDataList()) return false;
+        if (!readLabels(faceIndices)) return false;
+
+        if (faceOffsets->isEmpty()) return false;
+        if (faceOffsets->at(0) != 0) return false;
+        for (int i = 1; i < faceOffsets->size(); i++)
+        {
+            if (faceOffsets->at(i) < faceOffsets->at(i-1)) return false;
+        }
+        return (faceOffsets->last() == faceIndices->size());
+    }
+
+    if (!binaryFormat && readChunked(ListRecord::FACE, 1, nullptr, faceIndices, faceOffsets))
+    {
+        return expectChar(')');
+    }
+
+    //A face takes at least the bytes of "0()"
+    faceOffsets->reserve(reserveLimit(static_cast<qint64>(listSize) + 1, 3));
+    //Most faces are quads, this is only a first guess
+    faceIndices->reserve(reserveLimit(static_cast<qint64>(listSize) * 4, 2));
+
+    faceOffsets->append(0);
+
+    for (int i = 0; i < listSize; i++)
+    {
+        int faceSize;
+        if (!readInt(&faceSize)) return false;
+        if (faceSize < 0) return false;
+        if (!expectChar('(')) return false;
+        if (binaryFormat)
+        {
+            if (!readRawLabels(faceSize, faceIndices)) return false;
+        }
+        else
+        {
+            for (int j = 0; j < faceSize; j++)
+            {
+                int aVal;
+                if (!readInt(&aVal)) return false;
+                faceIndices->append(aVal);
+            }
+        }
+        if (!expectChar(')')) return false;
+        faceOffsets->append(faceIndices->size());
+    }
+
+    return expectChar(')');
+}
+
+bool CFDlistScanner::readPatches(QList<QByteArray> * patchNames, QList<QByteArray> * patchTypes,
+                                 QVector<int> * startFaces, QVector<int> * faceCounts)
+{
+    //Each patch is: name { key value; key value; ... }
+    //Only type, nFaces and startFace are kept. Other values are skipped.
+    if (listSize < 0) return false;
+
+    patchNames->clear();
+    patchTypes->clear();
+    startFaces->clear();
+    faceCounts->clear();
+
+    for (int i = 0; i < listSize; i++)
+    {
+        skipSpaceAndComments();
+        const char * nameStart;
+        if (!readWord(&nameStart)) return false;
+        QByteArray patchName(nameStart, static_cast<int>(myPos - nameStart));
+
+        if (!expectChar('{')) return false;
+
+        QByteArray patchType;
+        int startFace = -1;
+        int faceCount = -1;
+
+        while (true)
+        {
+            skipSpaceAndComments();
+            if (myPos == myEnd) return false;
+            if (*myPos == '}')
+            {
+                myPos++;
+                break;
+            }
+
+            const char * keyStart;
+            if (!readWord(&keyStart)) return false;
+            QByteArray keyWord = QByteArray::fromRawData(keyStart, static_cast<int>(myPos - keyStart));
+
+            //A value runs to the next ; and may contain lists or dictionaries
+            QByteArray firstValue;
+            while (true)
+            {
+                skipSpaceAndComments();
+                if (myPos == myEnd) return false;
+
+                char aLetter = *myPos;
+                if (aLetter == ';')
+                {
+                    myPos++;
+                    break;
+                }
+                else if (aLetter == '(')
+                {
+                    if (!skipEnclosed('(',')')) return false;
+                }
+                else if (aLetter == '{')
+                {
+                    if (!skipEnclosed('{','}')) return false;
+                }
+                else if (aLetter == '"')
+                {
+                    skipQuotedString();
+                }
+                else
+                {
+                    const char * valueStart;
+                    if (!readWord(&valueStart)) return false;
+                    if (firstValue.isEmpty())
+                    {
+                        firstValue = QByteArray(valueStart, static_cast<int>(myPos - valueStart));
+                    }
+                }
+            }
+
+            bool okCheck = true;
+            if (keyWord == "type") patchType = firstValue;
+            else if (keyWord == "nFaces") faceCount = firstValue.toInt(&okCheck);
+            else if (keyWord == "startFace") startFace = firstValue.toInt(&okCheck);
+            if (!okCheck) return false;
+        }
+
+        if ((startFace < 0) || (faceCount < 0)) return false;
+
+        patchNames->append(patchName);
+        patchTypes->append(patchType);
+        startFaces->append(startFace);
+        faceCounts->append(faceCount);
+    }
+
+    return expectChar(')');
+}
+
+bool CFDlistScanner::findListEnd(bool nestedRecords, const char ** listEnd)
+{
+    //Finds the closing paren of the list body, without parsing it.
+    //In a list of vectors or faces, it is the first ) followed by another )
+
+    const char * scanPos = myPos;
+    while (scanPos != myEnd)
+    {
+        scanPos = static_cast<const char *>(memchr(scanPos, ')', static_cast<size_t>(myEnd - scanPos)));
+        if (scanPos == nullptr) return false;
+
+        if (!nestedRecords)
+        {
+            *listEnd = scanPos;
+            return true;
+        }
+
+        scanPos++;
+        while ((scanPos != myEnd) && std::isspace(static_cast<unsigned char>(*scanPos))) scanPos++;
+        if ((scanPos != myEnd) && (*scanPos == ')'))
+        {
+            *listEnd = scanPos;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool CFDlistScanner::readChunked(ListRecord recordType, int width, QVector<double> * scalarOut,
+                                 QVector<int> * labelOut, QVector<int> * faceOffsets)
+{
+    //Returns false, with the scanner unmoved, if the list is small or the
+    //chunks do not add up. The caller then reads the list in one pass.
+    readInChunks = false;
+    if (!chunksAllowed || (listSize < CFD_CHUNKED_MIN_RECORDS)) return false;
+
+    bool nestedRecords = ((recordType == ListRecord::VECTOR) || (recordType == ListRecord::FACE));
+    const char * bodyEnd;
+    if (!findListEnd(nestedRecords, &bodyEnd)) return false;
+
+    qint64 bodyBytes = bodyEnd - myPos;
+    int chunkCount = qMin(QThread::idealThreadCount(), static_cast<int>(bodyBytes / CFD_CHUNKED_MIN_BYTES));
+    if (chunkCount < 2) return false;
+
+    //Each cut is moved forward to the next record boundary:
+    //after a ) for vectors and faces, at whitespace for single values
+    QVector<const char *> cutList;
+    cutList.append(myPos);
+    for (int i = 1; i < chunkCount; i++)
+    {
+        const char * cutPos = myPos + (bodyBytes * i) / chunkCount;
+        if (cutPos < cutList.last()) cutPos = cutList.last();
+
+        if (nestedRecords)
+        {
+            while ((cutPos != bodyEnd) && (*cutPos != ')')) cutPos++;
+            if (cutPos != bodyEnd) cutPos++;
+        }
+        else
+        {
+            while ((cutPos != bodyEnd) && !std::isspace(static_cast<unsigned char>(*cutPos))) cutPos++;
+        }
+        cutList.append(cutPos);
+    }
+    cutList.append(bodyEnd);
+
+    QVector<ListChunk> chunkList;
+    for (int i = 0; i < chunkCount; i++)
+    {
+        ListChunk aChunk;
+        aChunk.recordType = recordType;
+        aChunk.width = width;
+        aChunk.chunkStart = cutList.at(i);
+        aChunk.chunkEnd = cutList.at(i+1);
+        aChunk.sizeGuess = static_cast<int>(((aChunk.chunkEnd - aChunk.chunkStart) * listSize) / qMax(bodyBytes, qint64(1))) + 16;
+        chunkList.append(aChunk);
+    }
+
+    QtConcurrent::blockingMap(chunkList, &CFDlistScanner::readChunk);
+
+    int totalRecords = 0;
+    int totalValues = 0;
+    for (const ListChunk &aChunk : chunkList)
+    {
+        if (!aChunk.okay) return false;
+        totalRecords += aChunk.recordCount;
+        totalValues += (recordType == ListRecord::SCALAR || recordType == ListRecord::VECTOR) ?
+                    aChunk.scalarVals.size() : aChunk.labelVals.size();
+    }
+    if (totalRecords != listSize) return false;
+
+    if (scalarOut != nullptr)
+    {
+        scalarOut->clear();
+        scalarOut->reserve(totalValues);
+        for (const ListChunk &aChunk : chunkList) scalarOut->append(aChunk.scalarVals);
+    }
+    if (labelOut != nullptr)
+    {
+        labelOut->clear();
+        labelOut->reserve(totalValues);
+        for (const ListChunk &aChunk : chunkList) labelOut->append(aChunk.labelVals);
+    }
+    if (faceOffsets != nullptr)
+    {
+        faceOffsets->clear();
+        faceOffsets->reserve(totalRecords + 1);
+        faceOffsets->append(0);
+
+        int indexBase = 0;
+        for (const ListChunk &aChunk : chunkList)
+        {
+            for (int faceEnd : aChunk.faceEnds) faceOffsets->append(indexBase + faceEnd);
+            indexBase += aChunk.labelVals.size();
+        }
+    }
+
+    myPos = bodyEnd;
+    readInChunks = true;
+    return true;
+}
+
+void CFDlistScanner::readChunk(ListChunk &theChunk)
+{
+    //Note: This is run on a worker thread. It only touches its own chunk.
+    CFDlistScanner chunkScanner(theChunk.chunkStart, theChunk.chunkEnd);
+
+    if ((theChunk.recordType == ListRecord::SCALAR) || (theChunk.recordType == ListRecord::VECTOR))
+    {
+        theChunk.scalarVals.reserve(chunkScanner.reserveLimit(static_cast<qint64>(theChunk.sizeGuess) * theChunk.width, 2));
+    }
+    else
+    {
+        qint64 labelGuess = theChunk.sizeGuess;
+        if (theChunk.recordType == ListRecord::FACE) labelGuess *= 4;
+        theChunk.labelVals.reserve(chunkScanner.reserveLimit(labelGuess, 2));
+        if (theChunk.recordType == ListRecord::FACE) theChunk.faceEnds.reserve(chunkScanner.reserveLimit(theChunk.sizeGuess, 3));
+    }
+
+    chunkScanner.skipSpaceAndComments();
+    while (chunkScanner.myPos != chunkScanner.myEnd)
+    {
+        if (theChunk.recordType == ListRecord::SCALAR)
+        {
+            double aVal;
+            if (!chunkScanner.readDouble(&aVal)) return;
+            theChunk.scalarVals.append(aVal);
+        }
+        else if (theChunk.recordType == ListRecord::LABEL)
+        {
+            int aVal;
+            if (!chunkScanner.readInt(&aVal)) return;
+            theChunk.labelVals.append(aVal);
+        }
+        else if (theChunk.recordType == ListRecord::VECTOR)
+        {
+            if (!chunkScanner.expectChar('(')) return;
+            for (int j = 0; j < theChunk.width; j++)
+            {
+                double aVal;
+                if (!chunkScanner.readDouble(&aVal)) return;
+                theChunk.scalarVals.append(aVal);
+            }
+            if (!chunkScanner.expectChar(')')) return;
+        }
+        else
+        {
+            int faceSize;
+            if (!chunkScanner.readInt(&faceSize)) return;
+            if (faceSize < 0) return;
+            if (!chunkScanner.expectChar('(')) return;
+            for (int j = 0; j < faceSize; j++)
+            {
+                int aVal;
+                if (!chunkScanner.readInt(&aVal)) return;
+                theChunk.labelVals.append(aVal);
+            }
+            if (!chunkScanner.expectChar(')')) return;
+            theChunk.faceEnds.append(theChunk.labelVals.size());
+        }
+
+        theChunk.recordCount++;
+        chunkScanner.skipSpaceAndComments();
+    }
+
+    theChunk.okay = true;
+}
+
+void CFDlistScanner::skipSpaceAndComments()
+{
+    //Comments can be //
+    /* or have the multiline format */
+
+    while (true)
+    {
+        myPos = CFDnumberScanner::skipWhitespace(myPos, myEnd);
+        if (myPos == myEnd) return;
+
+        char aLetter = *myPos;
+        if ((aLetter != '/') || (myPos + 1 == myEnd))
+        {
+            return;
+        }
+
+        char nextLetter = *(myPos + 1);
+        if (nextLetter == '/')
+        {
+            while ((myPos != myEnd) && (*myPos != '\n')) myPos++;
+        }
+        else if (nextLetter == '*')
+        {
+            myPos += 2;
+            while ((myPos != myEnd) && !((*myPos == '*') && (myPos + 1 != myEnd) && (*(myPos + 1) == '/')))
+            {
+                myPos++;
+            }
+            if (myPos != myEnd) myPos += 2;
+        }
+        else
+        {
+            return;
+        }
+    }
+}
+
+bool CFDlistScanner::skipEnclosed(char openChar, char closeChar)
+{
+    int depth = 0;
+
+    while (true)
+    {
+        skipSpaceAndComments();
+        if (myPos == myEnd) return false;
+
+        char aLetter = *myPos;
+        if (aLetter == '"')
+        {
+            skipQuotedString();
+            continue;
+        }
+
+        myPos++;
+        if (aLetter == openChar)
+        {
+            depth++;
+        }
+        else if (aLetter == closeChar)
+        {
+            depth--;
+            if (depth == 0) return true;
+        }
+    }
+}
+
+void CFDlistScanner::skipQuotedString()
+{
+    myPos++;
+    while ((myPos != myEnd) && (*myPos != '"'))
+    {
+        if ((*myPos == '\\') && (myPos + 1 != myEnd)) myPos++;
+        myPos++;
+    }
+    if (myPos != myEnd) myPos++;
+}
+
+bool CFDlistScanner::readWord(const char ** wordStart)
+{
+    *wordStart = myPos;
+    while (myPos != myEnd)
+    {
+        char aLetter = *myPos;
+        if (std::isspace(static_cast<unsigned char>(aLetter))) break;
+        if ((aLetter == '(') || (aLetter == ')') || (aLetter == '{') || (aLetter == '}') ||
+                (aLetter == ';') || (aLetter == '"'))
+        {
+            break;
+        }
+        myPos++;
+    }
+    return (myPos != *wordStart);
+}
+
+bool CFDlistScanner::readFoamHeader()
+{
+    //Reads the entries of the FoamFile { ... } dictionary
+    //We only need: format, arch and class
+
+    myPos++;
+
+    while (true)
+    {
+        skipSpaceAndComments();
+        if (myPos == myEnd) return false;
+
+        if (*myPos == '}')
+        {
+            myPos++;
+            return true;
+        }
+        if (*myPos == ';')
+        {
+            myPos++;
+            continue;
+        }
+        if ((*myPos == '{') || (*myPos == '(') || (*myPos == '"') || (*myPos == ')'))
+        {
+            //Not expected in a FoamFile header
+            return false;
+        }
+
+        const char * keyStart;
+        readWord(&keyStart);
+        QByteArray keyWord = QByteArray::fromRawData(keyStart, static_cast<int>(myPos - keyStart));
+
+        skipSpaceAndComments();
+        if (myPos == myEnd) return false;
+
+        QByteArray valueWord;
+        if (*myPos == '"')
+        {
+            const char * valueStart = myPos + 1;
+            skipQuotedString();
+            valueWord = QByteArray(valueStart, static_cast<int>(myPos - valueStart - 1));
+        }
+        else if (*myPos == '{')
+        {
+            if (!skipEnclosed('{','}')) return false;
+            continue;
+        }
+        else
+        {
+            const char * valueStart;
+            readWord(&valueStart);
+            valueWord = QByteArray(valueStart, static_cast<int>(myPos - valueStart));
+        }
+
+        if (keyWord == "format")
+        {
+            binaryFormat = (valueWord == "binary");
+        }
+        else if (keyWord == "class")
+        {
+            headerClass = valueWord;
+        }
+        else if (keyWord == "arch")
+        {
+            setArchFromString(valueWord);
+        }
+    }
+}
+
+void CFDlistScanner::setArchFromString(QByteArray archString)
+{
+    //Example arch: "LSB;label=32;scalar=64"
+
+    for (const QByteArray &archPart : archString.split(';'))
+    {
+        if (archPart == "LSB")
+        {
+            swapBytes = (Q_BYTE_ORDER != Q_LITTLE_ENDIAN);
+        }
+        else if (archPart == "MSB")
+        {
+            swapBytes = (Q_BYTE_ORDER != Q_BIG_ENDIAN);
+        }
+        else if (archPart == "label=64")
+        {
+            labelBytes = 8;
+        }
+        else if (archPart == "label=32")
+        {
+            labelBytes = 4;
+        }
+        else if (archPart == "scalar=32")
+        {
+            scalarBytes = 4;
+        }
+        else if (archPart == "scalar=64")
+        {
+            scalarBytes = 8;
+        }
+    }
+}
+
+int CFDlistScanner::reserveLimit(qint64 wanted, int minEntryBytes)
+{
+    //The list size word is not trusted for a reserve: no more entries can be
+    //read than the rest of the input could hold
+    qint64 ret = qMin(wanted, static_cast<qint64>(myEnd - myPos) / minEntryBytes);
+    return static_cast<int>(qBound(qint64(0), ret, static_cast<qint64>(std::numeric_limits<int>::max())));
+}
+
+bool CFDlistScanner::readRawScalars(int count, QVector<double> * output)
+{
+    if (count < 0) return false;
+    qint64 byteCount = static_cast<qint64>(count) * scalarBytes;
+    if (byteCount > (myEnd - myPos)) return false;
+
+    int startSize = output->size();
+    output->resize(startSize + count);
+    double * writePtr = output->data() + startSize;
+
+    if ((scalarBytes == 8) && !swapBytes)
+    {
+        //Same layout as ours, so this is one block copy
+        std::memcpy(writePtr, myPos, static_cast<size_t>(byteCount));
+    }
+    else if (scalarBytes == 8)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            quint64 rawVal;
+            std::memcpy(&rawVal, myPos + 8 * i, 8);
+            rawVal = qbswap(rawVal);
+            std::memcpy(writePtr + i, &rawVal, 8);
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            quint32 rawVal;
+            std::memcpy(&rawVal, myPos + 4 * i, 4);
+            if (swapBytes) rawVal = qbswap(rawVal);
+            float aVal;
+            std::memcpy(&aVal, &rawVal, 4);
+            writePtr[i] = static_cast<double>(aVal);
+        }
+    }
+
+    myPos += byteCount;
+    return true;
+}
+
+bool CFDlistScanner::readRawLabels(int count, QVector<int> * output)
+{
+    if (count < 0) return false;
+    qint64 byteCount = static_cast<qint64>(count) * labelBytes;
+    if (byteCount > (myEnd - myPos)) return false;
+
+    int startSize = output->size();
+    output->resize(startSize + count);
+    int * writePtr = output->data() + startSize;
+
+    if ((labelBytes == 4) && !swapBytes)
+    {
+        //Same layout as ours, so this is one block copy
+        std::memcpy(writePtr, myPos, static_cast<size_t>(byteCount));
+    }
+    else if (labelBytes == 4)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            quint32 rawVal;
+            std::memcpy(&rawVal, myPos + 4 * i, 4);
+            writePtr[i] = static_cast<int>(qbswap(rawVal));
+        }
+    }
+    else
+    {
+        for (int i = 0; i < count; i++)
+        {
+            qint64 rawVal;
+            std::memcpy(&rawVal, myPos + 8 * i, 8);
+            if (swapBytes) rawVal = qbswap(rawVal);
+            //Note: Our index arrays are 32 bit, as are OpenGL's, so larger meshes are a parse error
+            if ((rawVal < std::numeric_limits<int>::min()) || (rawVal > std::numeric_limits<int>::max()))
+            {
+                output->resize(startSize);
+                return false;
+            }
+            writePtr[i] = static_cast<int>(rawVal);
+        }
+    }
+
+    myPos += byteCount;
+    return true;
+}
+
+bool CFDlistScanner::expectChar(char expected)
+{
+    skipSpaceAndComments();
+    if (myPos == myEnd) return false;
+    if (*myPos != expected) return false;
+    myPos++;
+    return true;
+}
+
+bool CFDlistScanner::readInt(int * val)
+{
+    skipSpaceAndComments();
+
+    //Labels may be written with 64 bits, but are stored as int
+    qint64 bigVal;
+    if (!CFDnumberScanner::scanLabel(&myPos, myEnd, &bigVal)) return false;
+    if ((bigVal < std::numeric_limits<int>::min()) || (bigVal > std::numeric_limits<int>::max())) return false;
+
+    *val = static_cast<int>(bigVal);
+    return true;
+}
+
+bool CFDlistScanner::readDouble(double * val)
+{
+    skipSpaceAndComments();
+    return CFDnumberScanner::scanDouble(&myPos, myEnd, val);
+}
@@ -0,0 +1,129 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDLISTSCANNER_H
+#define CFDLISTSCANNER_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QList>
+
+//Note: This is a single-pass reader for the large numeric lists in
+//OpenFOAM points/faces/owner/field files. It reads straight into flat arrays
+//and does not build a token tree. Use CFDtoken for anything else.
+
+//Both "format ascii" and "format binary" files are read. For binary files,
+//the FoamFile header "arch" entry gives the byte order and the label and
+//scalar sizes. Faces may be a faceList or a faceCompactList.
+
+//Large ascii list bodies are split at record boundaries and the pieces are
+//read on all cores. If any piece fails, the list is re-read in one pass.
+
+#define CFD_CHUNKED_MIN_RECORDS 65536
+#define CFD_CHUNKED_MIN_BYTES 1048576
+
+class CFDlistScanner
+{
+public:
+    explicit CFDlistScanner(const QByteArray * rawInput);
+
+    bool seekDataList();
+    int getListSize();
+
+    //Chunked reading is on by default. It is turned off to compare against a single pass.
+    void setChunkedReading(bool allowChunks);
+    bool lastReadWasChunked();
+
+    bool readVectors(int width, QVector<double> * output);
+    bool readScalars(QVector<double> * output);
+    bool readLabels(QVector<int> * output);
+    bool readFaces(QVector<int> * faceOffsets, QVector<int> * faceIndices);
+    //For polyMesh/boundary: a list of patch dictionaries
+    bool readPatches(QList<QByteArray> * patchNames, QList<QByteArray> * patchTypes,
+                     QVector<int> * startFaces, QVector<int> * faceCounts);
+
+private:
+    enum class ListRecord {SCALAR, LABEL, VECTOR, FACE};
+
+    struct ListChunk
+    {
+        ListRecord recordType;
+        int width;
+        const char * chunkStart;
+        const char * chunkEnd;
+        int sizeGuess;
+
+        QVector<double> scalarVals;
+        QVector<int> labelVals;
+        QVector<int> faceEnds;
+        int recordCount = 0;
+        bool okay = false;
+    };
+
+    CFDlistScanner(const char * rangeStart, const char * rangeEnd);
+
+    bool findListEnd(bool nestedRecords, const char ** listEnd);
+    bool readChunked(ListRecord recordType, int width, QVector<double> * scalarOut,
+                     QVector<int> * labelOut, QVector<int> * faceOffsets);
+    static void readChunk(ListChunk &theChunk);
+
+    void skipSpaceAndComments();
+    bool skipEnclosed(char openChar, char closeChar);
+    void skipQuotedString();
+    bool readWord(const char ** wordStart);
+    bool readFoamHeader();
+    void setArchFromString(QByteArray archString);
+
+    int reserveLimit(qint64 wanted, int minEntryBytes);
+    bool readRawScalars(int count, QVector<double> * output);
+    bool readRawLabels(int count, QVector<int> * output);
+
+    bool expectChar(char expected);
+    bool readInt(int * val);
+    bool readDouble(double * val);
+
+    const char * myPos;
+    const char * myEnd;
+    int listSize = -1;
+    bool chunksAllowed = true;
+    bool readInChunks = false;
+
+    QByteArray headerClass;
+    bool binaryFormat = false;
+    bool swapBytes = false;
+    int labelBytes = 4;
+    int scalarBytes = 8;
+};
+
+#endif // CFDLISTSCANNER_H
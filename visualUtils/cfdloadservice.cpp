@@ -0,0 +1,303 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdloadservice.h"
+
+#include "decompresswrapper.h"
+
+#include <QThread>
+#include <QFile>
+#include <QSaveFile>
+#include <QDateTime>
+
+CFDparseTask::CFDparseTask(QString fileID, QByteArray rawBuffer, bool isCompressed, QString valueType) :
+    QObject(nullptr), QRunnable()
+{
+    myFileID = fileID;
+    myRawBuffer = rawBuffer;
+    compressed = isCompressed;
+    myValueType = valueType;
+
+    setAutoDelete(false);
+}
+
+void CFDparseTask::run()
+{
+    //Note: This is run on a load service thread
+
+    if (wasCanceled())
+    {
+        emit taskDone(this);
+        return;
+    }
+
+    QByteArray * fileBuffer = &myRawBuffer;
+    QByteArray * inflatedBuffer = nullptr;
+
+    if (compressed)
+    {
+        DeCompressWrapper inflater(&myRawBuffer);
+        inflatedBuffer = inflater.getDecompressedFile();
+        //The compressed bytes are no longer needed
+        myRawBuffer.clear();
+        if (inflatedBuffer == nullptr)
+        {
+            myError = "Unable to decompress result file";
+            emit taskDone(this);
+            return;
+        }
+        fileBuffer = inflatedBuffer;
+    }
+
+    if (!wasCanceled())
+    {
+        if (myFileID == "data")
+        {
+            fieldPart = QSharedPointer<CFDfieldData>(new CFDfieldData());
+            fieldPart->readField(fileBuffer, myValueType);
+            myError = fieldPart->getError();
+        }
+        else
+        {
+            meshPart = QSharedPointer<CFDmeshData>(new CFDmeshData());
+            if (myFileID == "points") meshPart->readPoints(fileBuffer);
+            else if (myFileID == "faces") meshPart->readFaces(fileBuffer);
+            else if (myFileID == "owner") meshPart->readOwners(fileBuffer);
+            else if (myFileID == "boundary") meshPart->readBoundary(fileBuffer);
+            else myError = "Unknown mesh file type";
+
+            if (myError.isEmpty()) myError = meshPart->getError();
+        }
+    }
+
+    if (inflatedBuffer != nullptr) delete inflatedBuffer;
+    myRawBuffer.clear();
+
+    emit taskDone(this);
+}
+
+void CFDparseTask::cancel()
+{
+    canceled.storeRelease(1);
+}
+
+bool CFDparseTask::wasCanceled()
+{
+    return (canceled.loadAcquire() != 0);
+}
+
+QString CFDparseTask::getFileID()
+{
+    return myFileID;
+}
+
+QString CFDparseTask::getError()
+{
+    return myError;
+}
+
+QSharedPointer<CFDmeshData> CFDparseTask::getMeshPart()
+{
+    return meshPart;
+}
+
+QSharedPointer<CFDfieldData> CFDparseTask::getFieldPart()
+{
+    return fieldPart;
+}
+
+CFDcacheTask::CFDcacheTask(CacheTaskType taskType, QString remotePath, QString cacheFilePath,
+                           qint64 expectedSize, QByteArray fileBuffer) :
+    QObject(nullptr), QRunnable()
+{
+    myType = taskType;
+    myRemotePath = remotePath;
+    myCacheFilePath = cacheFilePath;
+    myExpectedSize = expectedSize;
+    myBuffer = fileBuffer;
+
+    setAutoDelete(false);
+}
+
+void CFDcacheTask::run()
+{
+    //Note: This is run on a load service thread
+
+    if (myType == CacheTaskType::READ)
+    {
+        QFile cacheFile(myCacheFilePath);
+        if (!cacheFile.open(QIODevice::ReadWrite))
+        {
+            emit taskDone(this);
+            return;
+        }
+
+        myBuffer = cacheFile.readAll();
+        if (myBuffer.size() != myExpectedSize)
+        {
+            myBuffer.clear();
+            cacheFile.close();
+            cacheFile.remove();
+            emit taskDone(this);
+            return;
+        }
+
+        //The file time marks its last use, for eviction
+        cacheFile.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+        cacheFile.close();
+        succeeded = true;
+        emit taskDone(this);
+        return;
+    }
+
+    //QSaveFile writes to a temporary file first, so a cache file is never partial
+    QSaveFile cacheFile(myCacheFilePath);
+    if (cacheFile.open(QIODevice::WriteOnly))
+    {
+        if (cacheFile.write(myBuffer) != myBuffer.size())
+        {
+            cacheFile.cancelWriting();
+        }
+        else
+        {
+            succeeded = cacheFile.commit();
+        }
+    }
+
+    //The written copy is not needed once on disk
+    myBuffer.clear();
+    emit taskDone(this);
+}
+
+CacheTaskType CFDcacheTask::getType()
+{
+    return myType;
+}
+
+QString CFDcacheTask::getRemotePath()
+{
+    return myRemotePath;
+}
+
+QString CFDcacheTask::getCacheFilePath()
+{
+    return myCacheFilePath;
+}
+
+qint64 CFDcacheTask::getExpectedSize()
+{
+    return myExpectedSize;
+}
+
+QByteArray CFDcacheTask::takeBuffer()
+{
+    QByteArray ret = std::move(myBuffer);
+    myBuffer.clear();
+    return ret;
+}
+
+bool CFDcacheTask::taskSucceeded()
+{
+    return succeeded;
+}
+
+CFDloadService::CFDloadService(QObject *parent) : QObject(parent)
+{
+    parsePool.setMaxThreadCount(QThread::idealThreadCount());
+    cachePool.setMaxThreadCount(2);
+}
+
+CFDloadService::~CFDloadService()
+{
+    parsePool.waitForDone();
+    cachePool.waitForDone();
+}
+
+CFDparseTask * CFDloadService::submitParse(QString fileID, QByteArray rawBuffer, bool isCompressed, QString valueType,
+                                           QObject * receiver, const char * member)
+{
+    CFDparseTask * newTask = new CFDparseTask(fileID, rawBuffer, isCompressed, valueType);
+
+    QObject::connect(newTask, SIGNAL(taskDone(CFDparseTask*)),
+                     receiver, member,
+                     Qt::QueuedConnection);
+    //Queued, so the task is deleted on the GUI thread after its receivers have run
+    QObject::connect(newTask, SIGNAL(taskDone(CFDparseTask*)),
+                     newTask, SLOT(deleteLater()),
+                     Qt::QueuedConnection);
+
+    parsePool.start(newTask);
+    return newTask;
+}
+
+void CFDloadService::cancelTask(CFDparseTask * theTask)
+{
+    //If the task has not started, it is removed and deleted here.
+    //Otherwise, it finishes early and deletes itself.
+    if (parsePool.tryTake(theTask))
+    {
+        delete theTask;
+        return;
+    }
+    theTask->cancel();
+}
+
+CFDcacheTask * CFDloadService::submitCacheRead(QString remotePath, QString cacheFilePath, qint64 expectedSize,
+                                               QObject * receiver, const char * member)
+{
+    return startCacheTask(new CFDcacheTask(CacheTaskType::READ, remotePath, cacheFilePath, expectedSize),
+                          receiver, member);
+}
+
+CFDcacheTask * CFDloadService::submitCacheWrite(QString remotePath, QString cacheFilePath, QByteArray fileBuffer,
+                                                QObject * receiver, const char * member)
+{
+    return startCacheTask(new CFDcacheTask(CacheTaskType::WRITE, remotePath, cacheFilePath,
+                                           fileBuffer.size(), fileBuffer),
+                          receiver, member);
+}
+
+CFDcacheTask * CFDloadService::startCacheTask(CFDcacheTask * newTask, QObject * receiver, const char * member)
+{
+    QObject::connect(newTask, SIGNAL(taskDone(CFDcacheTask*)),
+                     receiver, member,
+                     Qt::QueuedConnection);
+    //Queued, so the task is deleted on the GUI thread after its receivers have run
+    QObject::connect(newTask, SIGNAL(taskDone(CFDcacheTask*)),
+                     newTask, SLOT(deleteLater()),
+                     Qt::QueuedConnection);
+
+    cachePool.start(newTask);
+    return newTask;
+}
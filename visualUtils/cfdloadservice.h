@@ -0,0 +1,138 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDLOADSERVICE_H
+#define CFDLOADSERVICE_H
+
+#include <QObject>
+#include <QRunnable>
+#include <QThreadPool>
+#include <QAtomicInt>
+#include <QByteArray>
+#include <QSharedPointer>
+
+#include "cfdmeshdata.h"
+
+//Note: Result files are inflated and parsed on the load service's threads,
+//never on the GUI thread. Each file is one CFDparseTask. A task emits taskDone
+//on the GUI thread when finished, and then deletes itself.
+//Reads and writes of the local result cache are likewise CFDcacheTasks,
+//run on a separate small pool so large writes do not hold up parsing.
+
+class CFDparseTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    CFDparseTask(QString fileID, QByteArray rawBuffer, bool isCompressed, QString valueType);
+
+    virtual void run();
+    void cancel();
+    bool wasCanceled();
+
+    QString getFileID();
+    QString getError();
+    QSharedPointer<CFDmeshData> getMeshPart();
+    QSharedPointer<CFDfieldData> getFieldPart();
+
+signals:
+    void taskDone(CFDparseTask * theTask);
+
+private:
+    QString myFileID;
+    QByteArray myRawBuffer;
+    bool compressed;
+    QString myValueType;
+
+    QAtomicInt canceled;
+    QString myError;
+    QSharedPointer<CFDmeshData> meshPart;
+    QSharedPointer<CFDfieldData> fieldPart;
+};
+
+enum class CacheTaskType {READ, WRITE};
+
+class CFDcacheTask : public QObject, public QRunnable
+{
+    Q_OBJECT
+public:
+    CFDcacheTask(CacheTaskType taskType, QString remotePath, QString cacheFilePath,
+                 qint64 expectedSize, QByteArray fileBuffer = QByteArray());
+
+    virtual void run();
+
+    CacheTaskType getType();
+    QString getRemotePath();
+    QString getCacheFilePath();
+    qint64 getExpectedSize();
+    QByteArray takeBuffer();
+    bool taskSucceeded();
+
+signals:
+    void taskDone(CFDcacheTask * theTask);
+
+private:
+    CacheTaskType myType;
+    QString myRemotePath;
+    QString myCacheFilePath;
+    qint64 myExpectedSize;
+    QByteArray myBuffer;
+    bool succeeded = false;
+};
+
+class CFDloadService : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CFDloadService(QObject *parent = nullptr);
+    ~CFDloadService();
+
+    CFDparseTask * submitParse(QString fileID, QByteArray rawBuffer, bool isCompressed, QString valueType,
+                               QObject * receiver, const char * member);
+    void cancelTask(CFDparseTask * theTask);
+
+    CFDcacheTask * submitCacheRead(QString remotePath, QString cacheFilePath, qint64 expectedSize,
+                                   QObject * receiver, const char * member);
+    CFDcacheTask * submitCacheWrite(QString remotePath, QString cacheFilePath, QByteArray fileBuffer,
+                                    QObject * receiver, const char * member);
+    //Note: member is given with SLOT(), taking CFDparseTask * or CFDcacheTask *.
+    //It is connected before the task starts, so the task cannot finish unheard.
+
+private:
+    CFDcacheTask * startCacheTask(CFDcacheTask * newTask, QObject * receiver, const char * member);
+
+    QThreadPool parsePool;
+    QThreadPool cachePool;
+};
+
+#endif // CFDLOADSERVICE_H
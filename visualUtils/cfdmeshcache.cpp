@@ -0,0 +1,191 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdmeshcache.h"
+
+#include "cwe_globals.h"
+#include "CFDanalysis/cwefilechangedispatcher.h"
+
+#include "remoteFiles/filenoderef.h"
+#include "remoteFiles/filetreenode.h"
+#include "remoteFiles/fileoperator.h"
+
+CFDmeshCache::CFDmeshCache(QObject *parent) : QObject(parent) {}
+
+QString CFDmeshCache::makeMeshKey(QString stageFolder, QMap<QString, QString> meshFiles)
+{
+    //QMap keys are sorted, so the same files always give the same key
+    QString ret = stageFolder;
+    for (auto itr = meshFiles.cbegin(); itr != meshFiles.cend(); itr++)
+    {
+        ret.append("\n").append(itr.key()).append("=").append(itr.value());
+    }
+    return ret;
+}
+
+QSharedPointer<const CFDmeshData> CFDmeshCache::findMesh(QString meshKey)
+{
+    QSharedPointer<const CFDmeshData> ret;
+    if (!meshTable.contains(meshKey)) return ret;
+
+    CachedMesh &theEntry = meshTable[meshKey];
+    ret = theEntry.weakRef.toStrongRef();
+    if (ret.isNull())
+    {
+        QString stageFolder = theEntry.stageFolder;
+        meshTable.remove(meshKey);
+        releaseStageFolder(stageFolder);
+        return ret;
+    }
+
+    holdEntry(theEntry, ret);
+    enforceBudget();
+    return ret;
+}
+
+void CFDmeshCache::insertMesh(QString stageFolder, QString meshKey, QSharedPointer<const CFDmeshData> theMesh)
+{
+    if (theMesh.isNull()) return;
+
+    if (meshTable.contains(meshKey) && !meshTable[meshKey].heldRef.isNull())
+    {
+        heldBytes -= meshTable[meshKey].meshBytes;
+    }
+
+    CachedMesh newEntry;
+    newEntry.stageFolder = stageFolder;
+    newEntry.weakRef = theMesh;
+    newEntry.meshBytes = theMesh->getMemoryBytes();
+    newEntry.lastUse = 0;
+    meshTable[meshKey] = newEntry;
+
+    //Changes at, above or below the stage folder are the ones which can stale the mesh
+    cwe_globals::get_file_dispatcher()->watchPath(stageFolder, this, SLOT(fileChanged(FileNodeRef)));
+
+    holdEntry(meshTable[meshKey], theMesh);
+    enforceBudget();
+}
+
+void CFDmeshCache::fileChanged(FileNodeRef changedFile)
+{
+    if (changedFile.isNil()) return;
+    if (changedFile.getNodeState() != NodeState::DELETING) return;
+
+    //A mesh is stale if its stage, or anything in its polyMesh folder, is removed
+    QString changedPath = changedFile.getFullPath();
+    QStringList droppedFolders;
+
+    for (auto itr = meshTable.begin(); itr != meshTable.end();)
+    {
+        QString stageFolder = (*itr).stageFolder;
+        bool isStale = (stageFolder == changedPath) ||
+                stageFolder.startsWith(changedPath + "/") ||
+                changedPath.startsWith(stageFolder + "/constant/polyMesh");
+
+        if (!isStale)
+        {
+            itr++;
+            continue;
+        }
+
+        if (!(*itr).heldRef.isNull()) heldBytes -= (*itr).meshBytes;
+        droppedFolders.append(stageFolder);
+        itr = meshTable.erase(itr);
+    }
+
+    for (QString aFolder : droppedFolders)
+    {
+        releaseStageFolder(aFolder);
+    }
+}
+
+void CFDmeshCache::holdEntry(CachedMesh &theEntry, QSharedPointer<const CFDmeshData> theMesh)
+{
+    useCounter++;
+    theEntry.lastUse = useCounter;
+
+    if (!theEntry.heldRef.isNull()) return;
+    theEntry.heldRef = theMesh;
+    heldBytes += theEntry.meshBytes;
+}
+
+void CFDmeshCache::enforceBudget()
+{
+    //Least recently used meshes are released first.
+    //A released mesh is still found while a popup holds it.
+    while (heldBytes > CFD_MESH_CACHE_BUDGET)
+    {
+        CachedMesh * oldestEntry = nullptr;
+        for (CachedMesh &anEntry : meshTable)
+        {
+            if (anEntry.heldRef.isNull()) continue;
+            if ((oldestEntry == nullptr) || (anEntry.lastUse < oldestEntry->lastUse))
+            {
+                oldestEntry = &anEntry;
+            }
+        }
+        if (oldestEntry == nullptr) return;
+
+        oldestEntry->heldRef.clear();
+        heldBytes -= oldestEntry->meshBytes;
+    }
+
+    QStringList droppedFolders;
+    for (auto itr = meshTable.begin(); itr != meshTable.end();)
+    {
+        if ((*itr).heldRef.isNull() && (*itr).weakRef.isNull())
+        {
+            droppedFolders.append((*itr).stageFolder);
+            itr = meshTable.erase(itr);
+        }
+        else
+        {
+            itr++;
+        }
+    }
+
+    for (QString aFolder : droppedFolders)
+    {
+        releaseStageFolder(aFolder);
+    }
+}
+
+void CFDmeshCache::releaseStageFolder(QString stageFolder)
+{
+    for (const CachedMesh &anEntry : meshTable)
+    {
+        if (anEntry.stageFolder == stageFolder) return;
+    }
+    cwe_globals::get_file_dispatcher()->unwatchPath(stageFolder, this, SLOT(fileChanged(FileNodeRef)));
+}
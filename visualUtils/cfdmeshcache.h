@@ -0,0 +1,88 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDMESHCACHE_H
+#define CFDMESHCACHE_H
+
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QSharedPointer>
+#include <QWeakPointer>
+
+#include "cfdmeshdata.h"
+
+class FileNodeRef;
+
+//Note: Parsed meshes are shared by every result popup on the same stage.
+//A mesh stays available while any popup holds it. Past that, recently used
+//meshes are held until their total size passes the budget.
+//Meshes are dropped when their stage folder or mesh files are deleted.
+
+#define CFD_MESH_CACHE_BUDGET (512LL * 1024 * 1024)
+
+class CFDmeshCache : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CFDmeshCache(QObject *parent = nullptr);
+
+    static QString makeMeshKey(QString stageFolder, QMap<QString, QString> meshFiles);
+
+    QSharedPointer<const CFDmeshData> findMesh(QString meshKey);
+    void insertMesh(QString stageFolder, QString meshKey, QSharedPointer<const CFDmeshData> theMesh);
+
+private slots:
+    void fileChanged(FileNodeRef changedFile);
+
+private:
+    struct CachedMesh
+    {
+        QString stageFolder;
+        QWeakPointer<const CFDmeshData> weakRef;
+        QSharedPointer<const CFDmeshData> heldRef;
+        qint64 meshBytes;
+        quint64 lastUse;
+    };
+
+    void holdEntry(CachedMesh &theEntry, QSharedPointer<const CFDmeshData> theMesh);
+    void enforceBudget();
+    void releaseStageFolder(QString stageFolder);
+
+    QMap<QString, CachedMesh> meshTable;
+    qint64 heldBytes = 0;
+    quint64 useCounter = 0;
+};
+
+#endif // CFDMESHCACHE_H
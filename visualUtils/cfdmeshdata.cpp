@@ -0,0 +1,410 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdmeshdata.h"
+
+#include "cfdtoken.h"
+
+#include <QtMath>
+
+#include <algorithm>
+
+CFDmeshData::CFDmeshData() {}
+
+bool CFDmeshData::readPoints(QByteArray * rawPointFile)
+{
+    if (!CFDtoken::readVectorList(rawPointFile, 3, &pointCoords) || pointCoords.isEmpty())
+    {
+        myError = "Unable to read point list";
+        return false;
+    }
+    return true;
+}
+
+bool CFDmeshData::readFaces(QByteArray * rawFaceFile)
+{
+    if (!CFDtoken::readFaceList(rawFaceFile, &faceOffsets, &faceIndices) || (faceOffsets.size() < 2))
+    {
+        myError = "Unable to read face list";
+        return false;
+    }
+    return true;
+}
+
+bool CFDmeshData::readOwners(QByteArray * rawOwnerFile)
+{
+    if (!CFDtoken::readLabelList(rawOwnerFile, &ownerLabels) || ownerLabels.isEmpty())
+    {
+        myError = "Unable to read owner list";
+        return false;
+    }
+    return true;
+}
+
+bool CFDmeshData::readBoundary(QByteArray * rawBoundaryFile)
+{
+    QList<QByteArray> patchNames;
+    QList<QByteArray> patchTypes;
+    QVector<int> startFaces;
+    QVector<int> faceCounts;
+
+    patchList.clear();
+    if (!CFDtoken::readPatchList(rawBoundaryFile, &patchNames, &patchTypes, &startFaces, &faceCounts))
+    {
+        myError = "Unable to read boundary patch list";
+        return false;
+    }
+
+    for (int i = 0; i < patchNames.size(); i++)
+    {
+        CFDmeshPatch aPatch;
+        aPatch.name = QString::fromLatin1(patchNames.at(i));
+        aPatch.type = QString::fromLatin1(patchTypes.at(i));
+        aPatch.startFace = startFaces.at(i);
+        aPatch.faceCount = faceCounts.at(i);
+        patchList.append(aPatch);
+    }
+    return true;
+}
+
+void CFDmeshData::takePartsFrom(CFDmeshData * otherMesh)
+{
+    if (!otherMesh->pointCoords.isEmpty()) pointCoords.swap(otherMesh->pointCoords);
+    if (!otherMesh->faceOffsets.isEmpty())
+    {
+        faceOffsets.swap(otherMesh->faceOffsets);
+        faceIndices.swap(otherMesh->faceIndices);
+    }
+    if (!otherMesh->ownerLabels.isEmpty()) ownerLabels.swap(otherMesh->ownerLabels);
+    if (!otherMesh->patchList.isEmpty()) patchList.swap(otherMesh->patchList);
+
+    if (myError.isEmpty()) myError = otherMesh->myError;
+}
+
+bool CFDmeshData::checkMesh()
+{
+    //Call once all three files are read
+    if (!myError.isEmpty()) return false;
+
+    if (pointCoords.isEmpty() || (faceOffsets.size() < 2) || ownerLabels.isEmpty())
+    {
+        myError = "Unable to locate mesh data in files";
+        return false;
+    }
+
+    int numPoints = getPointCount();
+    for (int aIndex : faceIndices)
+    {
+        if ((aIndex < 0) || (aIndex >= numPoints))
+        {
+            myError = "Face list refers to non-existant point";
+            return false;
+        }
+    }
+
+    for (int i = 1; i < faceOffsets.size(); i++)
+    {
+        if (faceOffsets.at(i) <= faceOffsets.at(i-1))
+        {
+            myError = "Face list contains empty face";
+            return false;
+        }
+    }
+
+    if (ownerLabels.size() != getFaceCount())
+    {
+        myError = "Owner list does not match face list";
+        return false;
+    }
+
+    for (int aOwner : ownerLabels)
+    {
+        if (aOwner < 0)
+        {
+            myError = "Owner list refers to non-existant cell";
+            return false;
+        }
+    }
+
+    for (const CFDmeshPatch &aPatch : patchList)
+    {
+        if ((aPatch.startFace < 0) || (aPatch.faceCount < 0) ||
+                (aPatch.startFace + aPatch.faceCount > getFaceCount()))
+        {
+            myError = "Boundary patch refers to non-existant face";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void CFDmeshData::keepBoundaryFaces()
+{
+    if (patchList.isEmpty() || !myError.isEmpty()) return;
+
+    int keptFaces = 0;
+    int keptIndices = 0;
+    for (const CFDmeshPatch &aPatch : patchList)
+    {
+        keptFaces += aPatch.faceCount;
+        keptIndices += faceOffsets.at(aPatch.startFace + aPatch.faceCount) - faceOffsets.at(aPatch.startFace);
+    }
+
+    QVector<int> newOffsets;
+    QVector<int> newIndices;
+    QVector<int> newOwners;
+    newOffsets.reserve(keptFaces + 1);
+    newIndices.reserve(keptIndices);
+    newOwners.reserve(keptFaces);
+
+    newOffsets.append(0);
+    for (CFDmeshPatch &aPatch : patchList)
+    {
+        int oldStart = aPatch.startFace;
+        aPatch.startFace = newOwners.size();
+
+        for (int i = oldStart; i < oldStart + aPatch.faceCount; i++)
+        {
+            for (int j = faceOffsets.at(i); j < faceOffsets.at(i + 1); j++)
+            {
+                newIndices.append(faceIndices.at(j));
+            }
+            newOffsets.append(newIndices.size());
+            newOwners.append(ownerLabels.at(i));
+        }
+    }
+
+    faceOffsets.swap(newOffsets);
+    faceIndices.swap(newIndices);
+    ownerLabels.swap(newOwners);
+}
+
+QString CFDmeshData::getError() const
+{
+    return myError;
+}
+
+int CFDmeshData::getPointCount() const
+{
+    return pointCoords.size() / 3;
+}
+
+int CFDmeshData::getFaceCount() const
+{
+    if (faceOffsets.isEmpty()) return 0;
+    return faceOffsets.size() - 1;
+}
+
+const QVector<double> &CFDmeshData::getPointCoords() const
+{
+    return pointCoords;
+}
+
+const QVector<int> &CFDmeshData::getFaceOffsets() const
+{
+    return faceOffsets;
+}
+
+const QVector<int> &CFDmeshData::getFaceIndices() const
+{
+    return faceIndices;
+}
+
+const QVector<int> &CFDmeshData::getOwners() const
+{
+    return ownerLabels;
+}
+
+const QVector<CFDmeshPatch> &CFDmeshData::getPatches() const
+{
+    return patchList;
+}
+
+qint64 CFDmeshData::getMemoryBytes() const
+{
+    return static_cast<qint64>(pointCoords.size()) * static_cast<qint64>(sizeof(double)) +
+            static_cast<qint64>(faceOffsets.size() + faceIndices.size() + ownerLabels.size()) * static_cast<qint64>(sizeof(int)) +
+            static_cast<qint64>(patchList.size()) * static_cast<qint64>(sizeof(CFDmeshPatch));
+}
+
+CFDfieldData::CFDfieldData() {}
+
+bool CFDfieldData::readField(QByteArray * rawDataFile, QString valueType)
+{
+    dataValues.clear();
+
+    if (valueType == "scalar")
+    {
+        if (!CFDtoken::readScalarList(rawDataFile, &dataValues))
+        {
+            myError = "Unable to read scalar data file";
+            return false;
+        }
+    }
+    else if (valueType == "magnitude")
+    {
+        QVector<double> rawData;
+        if (!CFDtoken::readVectorList(rawDataFile, 3, &rawData))
+        {
+            myError = "Unable to read vector data file";
+            return false;
+        }
+
+        dataValues.reserve(rawData.size() / 3);
+        for (int i = 0; i + 2 < rawData.size(); i += 3)
+        {
+            double sum = rawData.at(i) * rawData.at(i) +
+                    rawData.at(i+1) * rawData.at(i+1) +
+                    rawData.at(i+2) * rawData.at(i+2);
+            dataValues.append(qSqrt(sum));
+        }
+    }
+    else
+    {
+        myError = "Invalid data type";
+        return false;
+    }
+
+    if (dataValues.isEmpty())
+    {
+        myError = "Unable to locate data in data file";
+        return false;
+    }
+
+    computeStats();
+    return true;
+}
+
+QString CFDfieldData::getError() const
+{
+    return myError;
+}
+
+const QVector<double> &CFDfieldData::getValues() const
+{
+    return dataValues;
+}
+
+double CFDfieldData::getMin() const
+{
+    return minVal;
+}
+
+double CFDfieldData::getMax() const
+{
+    return maxVal;
+}
+
+double CFDfieldData::getMean() const
+{
+    return meanVal;
+}
+
+const QVector<int> &CFDfieldData::getHistogram() const
+{
+    return histogram;
+}
+
+double CFDfieldData::getPercentile(double percent) const
+{
+    if (finiteCount == 0) return 0.0;
+
+    if (percent <= 0.0) return minVal;
+    if (percent >= 100.0) return maxVal;
+
+    int targetRank = qRound((percent / 100.0) * (finiteCount - 1));
+
+    int targetBin = 0;
+    int ranksBefore = 0;
+    while ((targetBin < histogram.size() - 1) && (ranksBefore + histogram.at(targetBin) <= targetRank))
+    {
+        ranksBefore += histogram.at(targetBin);
+        targetBin++;
+    }
+
+    QVector<double> binValues;
+    binValues.reserve(histogram.at(targetBin));
+    for (double aVal : dataValues)
+    {
+        if (qIsFinite(aVal) && (histogramBin(aVal) == targetBin)) binValues.append(aVal);
+    }
+    if (binValues.isEmpty()) return minVal;
+
+    int binRank = qBound(0, targetRank - ranksBefore, binValues.size() - 1);
+    std::nth_element(binValues.begin(), binValues.begin() + binRank, binValues.end());
+    return binValues.at(binRank);
+}
+
+void CFDfieldData::computeStats()
+{
+    minVal = 0.0;
+    maxVal = 0.0;
+    meanVal = 0.0;
+    finiteCount = 0;
+
+    //Note: The mean is kept as we go, since a sum of a large field can lose precision
+    for (double aVal : dataValues)
+    {
+        if (!qIsFinite(aVal)) continue;
+
+        finiteCount++;
+        if (finiteCount == 1)
+        {
+            minVal = aVal;
+            maxVal = aVal;
+        }
+        else
+        {
+            if (aVal < minVal) minVal = aVal;
+            if (aVal > maxVal) maxVal = aVal;
+        }
+        meanVal += (aVal - meanVal) / finiteCount;
+    }
+
+    histogram.fill(0, CFD_FIELD_HISTOGRAM_BINS);
+    for (double aVal : dataValues)
+    {
+        if (!qIsFinite(aVal)) continue;
+        histogram[histogramBin(aVal)]++;
+    }
+}
+
+int CFDfieldData::histogramBin(double aVal) const
+{
+    if ((maxVal <= minVal) || !qIsFinite(aVal)) return 0;
+
+    int ret = static_cast<int>(((aVal - minVal) / (maxVal - minVal)) * CFD_FIELD_HISTOGRAM_BINS);
+    return qBound(0, ret, CFD_FIELD_HISTOGRAM_BINS - 1);
+}
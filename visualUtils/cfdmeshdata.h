@@ -0,0 +1,136 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDMESHDATA_H
+#define CFDMESHDATA_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QString>
+#include <QSharedPointer>
+
+//Note: These hold parsed mesh and field data, apart from any canvas.
+//Each file can be read as soon as it arrives, in any order.
+//Once complete, they are passed to canvases as QSharedPointer<const ...>
+
+struct CFDmeshPatch
+{
+    QString name;
+    QString type;
+    int startFace;
+    int faceCount;
+};
+
+class CFDmeshData
+{
+public:
+    CFDmeshData();
+
+    bool readPoints(QByteArray * rawPointFile);
+    bool readFaces(QByteArray * rawFaceFile);
+    bool readOwners(QByteArray * rawOwnerFile);
+    bool readBoundary(QByteArray * rawBoundaryFile);
+
+    //Moves each list read by otherMesh into this mesh
+    void takePartsFrom(CFDmeshData * otherMesh);
+
+    bool checkMesh();
+    //Once checked, drops every face not in a boundary patch.
+    //Patches are renumbered to the faces kept. Does nothing without a boundary.
+    void keepBoundaryFaces();
+    QString getError() const;
+
+    int getPointCount() const;
+    int getFaceCount() const;
+
+    //Points are x,y,z triples
+    const QVector<double> &getPointCoords() const;
+    //Face i is faceIndices[faceOffsets[i]] to faceIndices[faceOffsets[i+1] - 1]
+    const QVector<int> &getFaceOffsets() const;
+    const QVector<int> &getFaceIndices() const;
+    const QVector<int> &getOwners() const;
+    //Empty unless the boundary file was read
+    const QVector<CFDmeshPatch> &getPatches() const;
+
+    qint64 getMemoryBytes() const;
+
+private:
+    QVector<double> pointCoords;
+    QVector<int> faceOffsets;
+    QVector<int> faceIndices;
+    QVector<int> ownerLabels;
+    QVector<CFDmeshPatch> patchList;
+
+    QString myError;
+};
+
+//Field stats are found in one pass when the field is read.
+//Percentiles are exact: the histogram finds the bin holding the value,
+//and only the values in that bin are searched.
+//NaN and inf values (from diverged runs) are left out of all the stats.
+#define CFD_FIELD_HISTOGRAM_BINS 1024
+
+class CFDfieldData
+{
+public:
+    CFDfieldData();
+
+    bool readField(QByteArray * rawDataFile, QString valueType);
+    QString getError() const;
+
+    const QVector<double> &getValues() const;
+
+    double getMin() const;
+    double getMax() const;
+    double getMean() const;
+    //Bins evenly divide min to max
+    const QVector<int> &getHistogram() const;
+    double getPercentile(double percent) const;
+
+private:
+    void computeStats();
+    int histogramBin(double aVal) const;
+
+    QVector<double> dataValues;
+
+    double minVal = 0.0;
+    double maxVal = 0.0;
+    double meanVal = 0.0;
+    int finiteCount = 0;
+    QVector<int> histogram;
+
+    QString myError;
+};
+
+#endif // CFDMESHDATA_H
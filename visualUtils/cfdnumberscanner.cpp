@@ -0,0 +1,343 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdnumberscanner.h"
+
+#include <QByteArray>
+#include <QtAlgorithms>
+
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define CFD_SCAN_SSE2
+#endif
+
+static const double exactPowersOfTen[] = {
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+    1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+const char * CFDnumberScanner::skipWhitespace(const char * pos, const char * end)
+{
+    //Most gaps are one character, so check that before using vectors
+    if ((pos == end) || ((*pos != ' ') && ((static_cast<unsigned char>(*pos) - 9u) >= 5u)))
+    {
+        return pos;
+    }
+
+#ifdef CFD_SCAN_SSE2
+    const __m128i spaceChar = _mm_set1_epi8(' ');
+    const __m128i ctrlShift = _mm_set1_epi8(static_cast<char>(128 - 9));
+    const __m128i ctrlLimit = _mm_set1_epi8(static_cast<char>(-128 + 5));
+
+    while (end - pos >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(pos));
+        //Whitespace is ' ' or 9 to 13 (\t \n \v \f \r)
+        __m128i isSpace = _mm_or_si128(_mm_cmpeq_epi8(chunk, spaceChar),
+                                       _mm_cmplt_epi8(_mm_add_epi8(chunk, ctrlShift), ctrlLimit));
+        unsigned int spaceMask = static_cast<unsigned int>(_mm_movemask_epi8(isSpace));
+        if (spaceMask != 0xFFFFu)
+        {
+            return pos + qCountTrailingZeroBits(~spaceMask);
+        }
+        pos += 16;
+    }
+#endif
+
+    while ((pos != end) && ((*pos == ' ') || ((static_cast<unsigned char>(*pos) - 9u) < 5u)))
+    {
+        pos++;
+    }
+    return pos;
+}
+
+bool CFDnumberScanner::scanLabel(const char ** pos, const char * end, qint64 * val)
+{
+    const char * scanPos = *pos;
+    if (scanPos == end) return false;
+
+    bool negative = false;
+    if ((*scanPos == '-') || (*scanPos == '+'))
+    {
+        negative = (*scanPos == '-');
+        scanPos++;
+    }
+
+    int numDigits = digitRunLength(scanPos, end);
+    //19 digits always fit in a qint64, up to 9.2e18
+    if ((numDigits == 0) || (numDigits > 19)) return false;
+
+    quint64 ret = 0;
+    for (int i = 0; i < numDigits; i++)
+    {
+        ret = ret * 10 + static_cast<quint64>(scanPos[i] - '0');
+    }
+    scanPos += numDigits;
+
+    //The negative range is one larger, down to -2^63
+    quint64 maxVal = static_cast<quint64>(std::numeric_limits<qint64>::max());
+    if (negative) maxVal++;
+    if (ret > maxVal) return false;
+    if ((scanPos != end) && isNumberChar(*scanPos)) return false;
+
+    if (!negative) *val = static_cast<qint64>(ret);
+    else if (ret == maxVal) *val = std::numeric_limits<qint64>::min();
+    else *val = -static_cast<qint64>(ret);
+    *pos = scanPos;
+    return true;
+}
+
+bool CFDnumberScanner::scanDouble(const char ** pos, const char * end, double * val)
+{
+    const char * numStart = *pos;
+    const char * scanPos = numStart;
+    if (scanPos == end) return false;
+
+    bool negative = false;
+    if ((*scanPos == '-') || (*scanPos == '+'))
+    {
+        negative = (*scanPos == '-');
+        scanPos++;
+    }
+
+    //Diverged runs write nan and inf words into ascii fields
+    if ((scanPos != end) && (((*scanPos | 0x20) == 'n') || ((*scanPos | 0x20) == 'i')))
+    {
+        return scanNonFinite(scanPos, pos, end, negative, val);
+    }
+
+    quint64 mantissa = 0;
+    int sigDigits = 0;
+    int exponent = 0;
+    bool anyDigits = false;
+    bool truncated = false;
+
+    int numDigits = digitRunLength(scanPos, end);
+    for (int i = 0; i < numDigits; i++)
+    {
+        if (sigDigits < 19)
+        {
+            mantissa = mantissa * 10 + static_cast<quint64>(scanPos[i] - '0');
+            if (mantissa != 0) sigDigits++;
+        }
+        else
+        {
+            exponent++;
+            truncated = true;
+        }
+    }
+    anyDigits = (numDigits > 0);
+    scanPos += numDigits;
+
+    if ((scanPos != end) && (*scanPos == '.'))
+    {
+        scanPos++;
+        numDigits = digitRunLength(scanPos, end);
+        for (int i = 0; i < numDigits; i++)
+        {
+            if (sigDigits < 19)
+            {
+                mantissa = mantissa * 10 + static_cast<quint64>(scanPos[i] - '0');
+                if (mantissa != 0) sigDigits++;
+                exponent--;
+            }
+            else
+            {
+                truncated = true;
+            }
+        }
+        anyDigits = anyDigits || (numDigits > 0);
+        scanPos += numDigits;
+    }
+
+    if (!anyDigits) return false;
+
+    if ((scanPos != end) && ((*scanPos == 'e') || (*scanPos == 'E')))
+    {
+        scanPos++;
+        bool negExp = false;
+        if ((scanPos != end) && ((*scanPos == '-') || (*scanPos == '+')))
+        {
+            negExp = (*scanPos == '-');
+            scanPos++;
+        }
+        numDigits = digitRunLength(scanPos, end);
+        if ((numDigits == 0) || (numDigits > 4)) return fallbackDouble(numStart, pos, end, val);
+
+        int expVal = 0;
+        for (int i = 0; i < numDigits; i++)
+        {
+            expVal = expVal * 10 + (scanPos[i] - '0');
+        }
+        scanPos += numDigits;
+        exponent += negExp ? -expVal : expVal;
+    }
+
+    if ((scanPos != end) && isNumberChar(*scanPos)) return false;
+
+    //Exact when the mantissa and the power of ten are both exact doubles
+    if (mantissa == 0)
+    {
+        *val = negative ? -0.0 : 0.0;
+    }
+    else if (!truncated && (mantissa <= (Q_UINT64_C(1) << 53)) && (exponent >= -22) && (exponent <= 22))
+    {
+        double ret = static_cast<double>(mantissa);
+        if (exponent < 0) ret /= exactPowersOfTen[-exponent];
+        else ret *= exactPowersOfTen[exponent];
+        *val = negative ? -ret : ret;
+    }
+    else
+    {
+        return fallbackDouble(numStart, pos, end, val);
+    }
+
+    *pos = scanPos;
+    return true;
+}
+
+bool CFDnumberScanner::readWholeLabel(const char * strStart, int strLen, qint64 * val)
+{
+    const char * scanPos = strStart;
+    if (!scanLabel(&scanPos, strStart + strLen, val)) return false;
+    return (scanPos == strStart + strLen);
+}
+
+bool CFDnumberScanner::readWholeDouble(const char * strStart, int strLen, double * val)
+{
+    const char * scanPos = strStart;
+    if (!scanDouble(&scanPos, strStart + strLen, val)) return false;
+    return (scanPos == strStart + strLen);
+}
+
+int CFDnumberScanner::digitRunLength(const char * pos, const char * end)
+{
+    const char * scanPos = pos;
+
+#ifdef CFD_SCAN_SSE2
+    const __m128i digitShift = _mm_set1_epi8(static_cast<char>(128 - '0'));
+    const __m128i digitLimit = _mm_set1_epi8(static_cast<char>(-128 + 10));
+
+    while (end - scanPos >= 16)
+    {
+        __m128i chunk = _mm_loadu_si128(reinterpret_cast<const __m128i *>(scanPos));
+        __m128i isDigit = _mm_cmplt_epi8(_mm_add_epi8(chunk, digitShift), digitLimit);
+        unsigned int digitMask = static_cast<unsigned int>(_mm_movemask_epi8(isDigit));
+        if (digitMask != 0xFFFFu)
+        {
+            return static_cast<int>(scanPos - pos) + qCountTrailingZeroBits(~digitMask);
+        }
+        scanPos += 16;
+    }
+#endif
+
+    while ((scanPos != end) && ((static_cast<unsigned char>(*scanPos) - static_cast<unsigned char>('0')) < 10u))
+    {
+        scanPos++;
+    }
+    return static_cast<int>(scanPos - pos);
+}
+
+bool CFDnumberScanner::isNumberChar(char aLetter)
+{
+    return (((static_cast<unsigned char>(aLetter) - static_cast<unsigned char>('0')) < 10u) ||
+            (aLetter == '.') || (aLetter == '-') || (aLetter == '+') ||
+            (aLetter == 'e') || (aLetter == 'E'));
+}
+
+bool CFDnumberScanner::matchWord(const char * pos, const char * end, const char * lowerWord)
+{
+    //Case-insensitive, as writers differ between nan, NaN and NAN
+    for (; *lowerWord != '\0'; pos++, lowerWord++)
+    {
+        if ((pos == end) || ((*pos | 0x20) != *lowerWord)) return false;
+    }
+    return true;
+}
+
+bool CFDnumberScanner::scanNonFinite(const char * wordStart, const char ** pos, const char * end,
+                                     bool negative, double * val)
+{
+    const char * scanPos = wordStart;
+    double ret;
+
+    if (matchWord(scanPos, end, "nan"))
+    {
+        //The sign of a NaN means nothing, so it is dropped
+        scanPos += 3;
+        ret = std::numeric_limits<double>::quiet_NaN();
+    }
+    else if (matchWord(scanPos, end, "infinity"))
+    {
+        scanPos += 8;
+        ret = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    }
+    else if (matchWord(scanPos, end, "inf"))
+    {
+        scanPos += 3;
+        ret = negative ? -std::numeric_limits<double>::infinity() : std::numeric_limits<double>::infinity();
+    }
+    else
+    {
+        return false;
+    }
+
+    //A longer word, such as "inflow", is not a number
+    if ((scanPos != end) && (isNumberChar(*scanPos) ||
+                             ((static_cast<unsigned char>(*scanPos | 0x20) - static_cast<unsigned char>('a')) < 26u)))
+    {
+        return false;
+    }
+
+    *val = ret;
+    *pos = scanPos;
+    return true;
+}
+
+bool CFDnumberScanner::fallbackDouble(const char * numStart, const char ** pos, const char * end, double * val)
+{
+    //For the rare numbers not exact on the fast path.
+    //Note: fromRawData does not copy, and toDouble is locale-independent
+    const char * scanPos = numStart;
+    while ((scanPos != end) && isNumberChar(*scanPos)) scanPos++;
+
+    bool okCheck;
+    double ret = QByteArray::fromRawData(numStart, static_cast<int>(scanPos - numStart)).toDouble(&okCheck);
+    if (!okCheck) return false;
+
+    *val = ret;
+    *pos = scanPos;
+    return true;
+}
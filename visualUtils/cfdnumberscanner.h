@@ -0,0 +1,69 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDNUMBERSCANNER_H
+#define CFDNUMBERSCANNER_H
+
+#include <QtGlobal>
+
+//Note: Locale-independent number reading for CFD files. Whitespace and digit
+//runs are found 16 bytes at a time where SSE2 is available. Doubles with up to
+//19 significant digits and small exponents are computed exactly; anything else
+//falls back to QByteArray::toDouble, so results are always correctly rounded.
+//The words nan, inf and infinity are read in any case, with an optional sign.
+
+class CFDnumberScanner
+{
+public:
+    static const char * skipWhitespace(const char * pos, const char * end);
+
+    //These advance *pos past the number read, and fail if the number runs
+    //into another number character (such as "1.2.3")
+    static bool scanLabel(const char ** pos, const char * end, qint64 * val);
+    static bool scanDouble(const char ** pos, const char * end, double * val);
+
+    //These succeed only if the whole string is the number
+    static bool readWholeLabel(const char * strStart, int strLen, qint64 * val);
+    static bool readWholeDouble(const char * strStart, int strLen, double * val);
+
+private:
+    static int digitRunLength(const char * pos, const char * end);
+    static bool isNumberChar(char aLetter);
+    static bool matchWord(const char * pos, const char * end, const char * lowerWord);
+    static bool scanNonFinite(const char * wordStart, const char ** pos, const char * end,
+                              bool negative, double * val);
+    static bool fallbackDouble(const char * numStart, const char ** pos, const char * end, double * val);
+};
+
+#endif // CFDNUMBERSCANNER_H
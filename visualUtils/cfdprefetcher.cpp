@@ -0,0 +1,366 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#include "cfdprefetcher.h"
+
+#include "cwe_globals.h"
+#include "CFDanalysis/cwefilechangedispatcher.h"
+#include "cfdfetchscheduler.h"
+#include "cfdbuffercache.h"
+#include "resultprocurebase.h"
+
+#include "remoteFiles/filetreenode.h"
+#include "remoteFiles/fileoperator.h"
+#include "filemetadata.h"
+
+CFDprefetcher::CFDprefetcher(QObject *parent) : QObject(parent)
+{
+    paceTimer.setSingleShot(true);
+    QObject::connect(&paceTimer, SIGNAL(timeout()),
+                     this, SLOT(advance()));
+    QObject::connect(cwe_globals::get_buffer_cache(), SIGNAL(bufferStored(QString)),
+                     this, SLOT(cacheBufferStored(QString)),
+                     Qt::QueuedConnection);
+    QObject::connect(cwe_globals::get_fetch_scheduler(), SIGNAL(fetchFailed(QString)),
+                     this, SLOT(advance()),
+                     Qt::QueuedConnection);
+}
+
+void CFDprefetcher::setEnabled(bool newSetting)
+{
+    prefetchOn = newSetting;
+    if (!prefetchOn)
+    {
+        clearQueues();
+    }
+}
+
+bool CFDprefetcher::isEnabled()
+{
+    return prefetchOn;
+}
+
+void CFDprefetcher::stageFinished(FileNodeRef caseFolder, QList<RESULT_ENTRY> resultList)
+{
+    if (!prefetchOn) return;
+    if (caseFolder.isNil()) return;
+
+    //Results are grouped by the stage folder they are read from
+    QMap<QString, QStringList> stageFiles;
+    for (const RESULT_ENTRY &aResult : resultList)
+    {
+        for (QString aFile : filesForResult(aResult))
+        {
+            if (stageFiles[aResult.stage].contains(aFile)) continue;
+            stageFiles[aResult.stage].append(aFile);
+        }
+    }
+
+    for (QString aStage : stageFiles.keys())
+    {
+        FileNodeRef stageFolder = caseFolder.getChildWithName(aStage);
+        if (stageFolder.isNil()) continue;
+        if (queuedStages.contains(stageFolder.getFullPath())) continue;
+        queuedStages.insert(stageFolder.getFullPath());
+
+        PrefetchStage newStage;
+        newStage.stageFolder = stageFolder;
+        newStage.stagePath = stageFolder.getFullPath();
+        newStage.fileNames = stageFiles.value(aStage);
+        stageQueue.append(newStage);
+    }
+
+    if (!paceClock.isValid())
+    {
+        paceClock.start();
+        bytesIssued = 0;
+    }
+
+    advance();
+}
+
+void CFDprefetcher::advance()
+{
+    if (!prefetchOn) return;
+
+    issueNextFile();
+    updateWatches();
+}
+
+void CFDprefetcher::issueNextFile()
+{
+    checkCurrentFile();
+    if (!currentFile.isNil()) return;
+
+    resolveStages();
+
+    while (!fileQueue.isEmpty())
+    {
+        FileNodeRef nextFile = fileQueue.first();
+        if (nextFile.isNil() || nextFile.fileBufferLoaded() ||
+                cwe_globals::get_buffer_cache()->hasBuffer(nextFile))
+        {
+            fileQueue.removeFirst();
+            continue;
+        }
+
+        //Wait until the sizes of the files requested so far allow another start
+        qint64 msecAllowed = bytesIssued * 1000 / CFD_PREFETCH_START_PACE;
+        qint64 msecWaited = paceClock.elapsed();
+        if (msecWaited < msecAllowed)
+        {
+            if (!paceTimer.isActive())
+            {
+                paceTimer.start(static_cast<int>(msecAllowed - msecWaited));
+            }
+            return;
+        }
+
+        fileQueue.removeFirst();
+        currentFile = nextFile;
+        bytesIssued += nextFile.getFileData().getSize();
+        cwe_globals::get_fetch_scheduler()->requestFile(nextFile, FetchPriority::PREFETCH);
+        return;
+    }
+
+    if (stageQueue.isEmpty())
+    {
+        paceClock.invalidate();
+    }
+}
+
+QStringList CFDprefetcher::filesForResult(const RESULT_ENTRY &resultEntry)
+{
+    //These match the files read by the result windows
+    QStringList ret;
+    if ((resultEntry.type != "GLmesh") && (resultEntry.type != "GLmesh3D") &&
+            (resultEntry.type != "GLdata"))
+    {
+        return ret;
+    }
+
+    ret.append("/constant/polyMesh/points.gz");
+    ret.append("/constant/polyMesh/faces.gz");
+    ret.append("/constant/polyMesh/owner.gz");
+
+    if (resultEntry.type == "GLmesh3D")
+    {
+        ret.append("/constant/polyMesh/boundary.gz");
+    }
+    else if (resultEntry.type == "GLdata")
+    {
+        QString fieldFile = "[final]/";
+        fieldFile.append(resultEntry.file).append(".gz");
+        ret.append(fieldFile);
+    }
+
+    return ret;
+}
+
+FileNodeRef CFDprefetcher::resolveFile(FileNodeRef stageFolder, QString fileName, bool * retryLater)
+{
+    *retryLater = false;
+    FileNodeRef ret;
+
+    if (fileName.startsWith("[final]"))
+    {
+        if (!stageFolder.folderContentsLoaded())
+        {
+            stageFolder.enactFolderRefresh();
+            *retryLater = true;
+            return ret;
+        }
+
+        FileNodeRef lastResult = ResultProcureBase::findFinalResultFolder(stageFolder);
+        if (lastResult.isNil()) return ret;
+
+        fileName.remove(0,7);
+        return cwe_globals::get_file_handle()->speculateFileWithName(lastResult, fileName, false);
+    }
+
+    ret = cwe_globals::get_file_handle()->speculateFileWithName(stageFolder, fileName, false);
+    if (ret.isNil() && fileName.endsWith(".gz"))
+    {
+        fileName.chop(3);
+        ret = cwe_globals::get_file_handle()->speculateFileWithName(stageFolder, fileName, false);
+    }
+    return ret;
+}
+
+void CFDprefetcher::resolveStages()
+{
+    for (auto itr = stageQueue.begin(); itr != stageQueue.end();)
+    {
+        //Once a stage is resolved, or its folder is gone, it may be queued again,
+        //as it will be if it is rolled back and run again
+        if ((*itr).stageFolder.isNil())
+        {
+            queuedStages.remove((*itr).stagePath);
+            itr = stageQueue.erase(itr);
+            continue;
+        }
+
+        QStringList unresolvedNames;
+        for (QString aName : (*itr).fileNames)
+        {
+            bool retryLater = false;
+            FileNodeRef aFile = resolveFile((*itr).stageFolder, aName, &retryLater);
+            if (retryLater)
+            {
+                unresolvedNames.append(aName);
+            }
+            else if (!aFile.isNil())
+            {
+                fileQueue.append(aFile);
+            }
+        }
+
+        if (unresolvedNames.isEmpty())
+        {
+            queuedStages.remove((*itr).stagePath);
+            itr = stageQueue.erase(itr);
+        }
+        else
+        {
+            (*itr).fileNames = unresolvedNames;
+            itr++;
+        }
+    }
+}
+
+void CFDprefetcher::checkCurrentFile()
+{
+    if (currentFile.isNil()) return;
+
+    if (currentFile.fileBufferLoaded())
+    {
+        holdFile(currentFile);
+        FileNodeRef nil;
+        currentFile = nil;
+        return;
+    }
+
+    //A fetch the scheduler has given up on is dropped
+    if (!cwe_globals::get_fetch_scheduler()->fileIsPending(currentFile))
+    {
+        FileNodeRef nil;
+        currentFile = nil;
+    }
+}
+
+void CFDprefetcher::holdFile(FileNodeRef fileNode)
+{
+    cwe_globals::get_buffer_cache()->storeBuffer(fileNode, fileNode.getFileBuffer());
+
+    qint64 fileSize = fileNode.getFileData().getSize();
+    heldFiles.append(QPair<FileNodeRef, qint64>(fileNode, fileSize));
+    heldBytes += fileSize;
+
+    //The newest file is kept, even if it alone is over the cap
+    while ((heldBytes > CFD_PREFETCH_MEMORY_CAP) && (heldFiles.size() > 1))
+    {
+        QPair<FileNodeRef, qint64> oldEntry = heldFiles.takeFirst();
+        heldBytes -= oldEntry.second;
+
+        FileNodeRef oldFile = oldEntry.first;
+        if (oldFile.isNil()) continue;
+        if (!oldFile.fileBufferLoaded()) continue;
+        if (cwe_globals::get_fetch_scheduler()->fileIsPending(oldFile)) continue;
+        //The cache writes on the load service, so the disk copy may not be there yet
+        if (!cwe_globals::get_buffer_cache()->hasBuffer(oldFile))
+        {
+            releaseWhenStored.append(oldFile);
+            continue;
+        }
+        oldFile.setFileBuffer(nullptr);
+    }
+}
+
+void CFDprefetcher::cacheBufferStored(QString remotePath)
+{
+    for (auto itr = releaseWhenStored.begin(); itr != releaseWhenStored.end();)
+    {
+        FileNodeRef aFile = (*itr);
+        if (aFile.isNil())
+        {
+            itr = releaseWhenStored.erase(itr);
+            continue;
+        }
+        if (aFile.getFullPath() != remotePath)
+        {
+            itr++;
+            continue;
+        }
+
+        if (aFile.fileBufferLoaded() && !cwe_globals::get_fetch_scheduler()->fileIsPending(aFile) &&
+                cwe_globals::get_buffer_cache()->hasBuffer(aFile))
+        {
+            aFile.setFileBuffer(nullptr);
+        }
+        itr = releaseWhenStored.erase(itr);
+    }
+}
+
+void CFDprefetcher::clearQueues()
+{
+    stageQueue.clear();
+    fileQueue.clear();
+    queuedStages.clear();
+    FileNodeRef nil;
+    currentFile = nil;
+    paceTimer.stop();
+    paceClock.invalidate();
+    updateWatches();
+}
+
+void CFDprefetcher::updateWatches()
+{
+    //Only the queued stage folders and the file being fetched can move the queue along
+    QSet<QString> neededPaths = queuedStages;
+    if (!currentFile.isNil())
+    {
+        neededPaths.insert(currentFile.getFullPath());
+    }
+
+    CWEfileChangeDispatcher * theDispatcher = cwe_globals::get_file_dispatcher();
+    for (QString aPath : watchedPaths - neededPaths)
+    {
+        theDispatcher->unwatchPath(aPath, this, SLOT(advance()));
+    }
+    for (QString aPath : neededPaths - watchedPaths)
+    {
+        theDispatcher->watchPath(aPath, this, SLOT(advance()));
+    }
+    watchedPaths = neededPaths;
+}
@@ -0,0 +1,109 @@
+/*********************************************************************************
+**
+** Copyright (c) 2017 The University of Notre Dame
+** Copyright (c) 2017 The Regents of the University of California
+**
+** Redistribution and use in source and binary forms, with or without modification,
+** are permitted provided that the following conditions are met:
+**
+** 1. Redistributions of source code must retain the above copyright notice, this
+** list of conditions and the following disclaimer.
+**
+** 2. Redistributions in binary form must reproduce the above copyright notice, this
+** list of conditions and the following disclaimer in the documentation and/or other
+** materials provided with the distribution.
+**
+** 3. Neither the name of the copyright holder nor the names of its contributors may
+** be used to endorse or promote products derived from this software without specific
+** prior written permission.
+**
+** THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS" AND ANY
+** EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE IMPLIED WARRANTIES
+** OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE DISCLAIMED. IN NO EVENT
+** SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE FOR ANY DIRECT, INDIRECT,
+** INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED
+** TO, PROCUREMENT OF SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR
+** BUSINESS INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+** CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING
+** IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF
+** SUCH DAMAGE.
+**
+***********************************************************************************/
+
+// Contributors:
+
+#ifndef CFDPREFETCHER_H
+#define CFDPREFETCHER_H
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+#include <QPair>
+#include <QStringList>
+#include <QTimer>
+#include <QElapsedTimer>
+
+#include "remoteFiles/filenoderef.h"
+#include "CFDanalysis/cweanalysistype.h"
+
+//Note: When turned on, the result files of a newly finished stage are
+//downloaded in the background, so that opening a result view later does not
+//wait on the network. One file is fetched at a time, at prefetch priority.
+//Request starts are paced by file size to CFD_PREFETCH_START_PACE bytes per
+//second. This only spaces out requests; bytes received are not measured.
+//Each file goes to the local buffer cache. Past CFD_PREFETCH_MEMORY_CAP, the
+//oldest prefetched buffers are dropped from memory; their copy on disk remains.
+
+#define CFD_PREFETCH_START_PACE (4LL * 1024 * 1024)
+#define CFD_PREFETCH_MEMORY_CAP (256LL * 1024 * 1024)
+
+class CFDprefetcher : public QObject
+{
+    Q_OBJECT
+public:
+    explicit CFDprefetcher(QObject *parent = nullptr);
+
+    void setEnabled(bool newSetting);
+    bool isEnabled();
+
+    void stageFinished(FileNodeRef caseFolder, QList<RESULT_ENTRY> resultList);
+
+private slots:
+    void advance();
+    void cacheBufferStored(QString remotePath);
+
+private:
+    struct PrefetchStage
+    {
+        FileNodeRef stageFolder;
+        QString stagePath;
+        QStringList fileNames;
+    };
+
+    static QStringList filesForResult(const RESULT_ENTRY &resultEntry);
+    FileNodeRef resolveFile(FileNodeRef stageFolder, QString fileName, bool * retryLater);
+    void issueNextFile();
+    void resolveStages();
+    void checkCurrentFile();
+    void holdFile(FileNodeRef fileNode);
+    void clearQueues();
+    void updateWatches();
+
+    bool prefetchOn = false;
+
+    QList<PrefetchStage> stageQueue;
+    QList<FileNodeRef> fileQueue;
+    QSet<QString> queuedStages;
+    FileNodeRef currentFile;
+    QSet<QString> watchedPaths;
+
+    QList<QPair<FileNodeRef, qint64>> heldFiles;
+    QList<FileNodeRef> releaseWhenStored;
+    qint64 heldBytes = 0;
+
+    QElapsedTimer paceClock;
+    qint64 bytesIssued = 0;
+    QTimer paceTimer;
+};
+
+#endif // CFDPREFETCHER_H
@@ -35,14 +35,117 @@
 
 #include "cfdtoken.h"
 
-CFDtoken::CFDtoken()
+#include "cfdlistscanner.h"
+#include "cfdnumberscanner.h"
+
+#include <cctype>
+#include <limits>
+#include <new>
+
+CFDtokenSpan::CFDtokenSpan(CFDtoken * const * start, int size)
+{
+    myStart = start;
+    mySize = size;
+}
+
+CFDtoken * const * CFDtokenSpan::begin() const
+{
+    return myStart;
+}
+
+CFDtoken * const * CFDtokenSpan::end() const
+{
+    return myStart + mySize;
+}
+
+CFDtoken * const * CFDtokenSpan::cbegin() const
+{
+    return begin();
+}
+
+CFDtoken * const * CFDtokenSpan::cend() const
+{
+    return end();
+}
+
+CFDtoken * CFDtokenSpan::at(int index) const
+{
+    return myStart[index];
+}
+
+int CFDtokenSpan::size() const
+{
+    return mySize;
+}
+
+bool CFDtokenSpan::isEmpty() const
+{
+    return (mySize == 0);
+}
+
+CFDtokenArena::CFDtokenArena(const QByteArray &source)
+{
+    mySource = source;
+}
+
+CFDtokenArena::~CFDtokenArena()
+{
+    //Note: Tokens in the arena hold no resources of their own,
+    //so the blocks are released without running each destructor
+    for (void * aBlock : tokenBlocks)
+    {
+        ::operator delete(aBlock);
+    }
+    for (void * aBlock : childBlocks)
+    {
+        ::operator delete(aBlock);
+    }
+}
+
+CFDtoken * CFDtokenArena::newToken()
 {
-    nullfiyContent();
+    if (tokensLeftInBlock == 0)
+    {
+        void * newBlock = ::operator new(sizeof(CFDtoken) * TOKEN_BLOCK_SIZE);
+        tokenBlocks.append(newBlock);
+        nextToken = static_cast<CFDtoken *>(newBlock);
+        tokensLeftInBlock = TOKEN_BLOCK_SIZE;
+    }
+
+    CFDtoken * ret = new (nextToken) CFDtoken();
+    nextToken++;
+    tokensLeftInBlock--;
+    return ret;
+}
+
+CFDtoken ** CFDtokenArena::newChildSpan(int size)
+{
+    if (size <= 0) return nullptr;
+
+    if (size > childrenLeftInBlock)
+    {
+        int blockSize = (size > CHILD_BLOCK_SIZE) ? size : CHILD_BLOCK_SIZE;
+        void * newBlock = ::operator new(sizeof(CFDtoken *) * static_cast<size_t>(blockSize));
+        childBlocks.append(newBlock);
+        nextChild = static_cast<CFDtoken **>(newBlock);
+        childrenLeftInBlock = blockSize;
+    }
+
+    CFDtoken ** ret = nextChild;
+    nextChild += size;
+    childrenLeftInBlock -= size;
+    return ret;
 }
 
+CFDtoken::CFDtoken() {}
+
 CFDtoken::~CFDtoken()
 {
-    nullfiyContent();
+    //Note: Only the root token has an arena
+    if (myArena != nullptr)
+    {
+        delete myArena;
+    }
 }
 
 CFDtokenType CFDtoken::getType()
@@ -74,30 +177,31 @@ QByteArray CFDtoken::getStringVal()
     {
         return QByteArray::number(myFloat);
     }
-    return myString;
+    return QByteArray(myStrStart, myStrLen);
 }
 
-QLinkedList<CFDtoken *> CFDtoken::getChildList()
+CFDtokenSpan CFDtoken::getChildList()
 {
-    return childList;
+    return CFDtokenSpan(myChildren, myChildCount);
 }
 
 int CFDtoken::getChildSize()
 {
-    return childList.size();
+    return myChildCount;
 }
 
 CFDtoken * CFDtoken::getLargestChildArray()
 {
     CFDtoken * ret = nullptr;
     int refSize = -1;
-    for (auto itr = childList.begin(); itr != childList.end(); itr++)
+    for (CFDtoken * aChild : getChildList())
     {
-        if ((*itr)->getType() == CFDtokenType::DATA_ARRAY)
+        if (aChild->getType() == CFDtokenType::DATA_ARRAY)
         {
-            if ((*itr)->getChildSize() > refSize)
+            if (aChild->getChildSize() > refSize)
             {
-                ret = (*itr);
+                ret = aChild;
+                refSize = aChild->getChildSize();
             }
         }
     }
@@ -114,89 +218,89 @@ QByteArray * CFDtoken::stripCFDcomments(QByteArray * rawInput)
     //Comments can be //
     /* or have the multiline format */
 
-    while (rawInput->contains("/*"))
-    {
-        int startComment = rawInput->indexOf("/*");
-        int endComment = rawInput->indexOf("*/", startComment);
-        if (endComment != -1)
-        {
-            int commentLen = endComment - startComment + 2;
-            rawInput->remove(startComment,commentLen);
-        }
-    }
+    //Note: This compacts the buffer in place in one pass, rather than
+    //removing each comment, which shifts the whole rest of the buffer
+    char * writePtr = rawInput->data();
+    const char * readPtr = writePtr;
+    const char * endPtr = readPtr + rawInput->size();
 
-    while (rawInput->contains("//"))
+    while (readPtr != endPtr)
     {
-        int startComment = rawInput->indexOf("//");
-        int endComment = rawInput->indexOf("\n", startComment);
-        if (endComment != -1)
+        int commentLen = commentLength(readPtr, endPtr);
+        if (commentLen > 0)
         {
-            int commentLen = endComment - startComment;
-            rawInput->remove(startComment,commentLen);
+            readPtr += commentLen;
+            continue;
         }
+        *writePtr = *readPtr;
+        writePtr++;
+        readPtr++;
     }
+
+    rawInput->resize(static_cast<int>(writePtr - rawInput->constData()));
     return rawInput;
 }
 
 CFDtoken * CFDtoken::lexifyString(QByteArray * rawInput)
 {
-    bool withinToken = false;
-
-    rawInput = stripCFDcomments(rawInput);
+    //Note: Comments are skipped as we go, so the input is not modified
 
     CFDtoken * ret = new CFDtoken();
+    ret->myArena = new CFDtokenArena(*rawInput);
 
-    QByteArray oneToken;
+    QVector<CFDtoken *> tokenList;
 
-    for (auto itr = rawInput->cbegin(); itr != rawInput->cend(); itr++)
+    const char * tokenStart = nullptr;
+    const char * readPtr = rawInput->constData();
+    const char * endPtr = readPtr + rawInput->size();
+
+    while (readPtr != endPtr)
     {
-        char aLetter = (*itr);
+        char aLetter = *readPtr;
 
-        if (std::isspace(aLetter))
+        int commentLen = commentLength(readPtr, endPtr);
+        if ((commentLen > 0) || std::isspace(static_cast<unsigned char>(aLetter)))
         {
-            if (withinToken)
+            if (tokenStart != nullptr)
             {
-                CFDtoken * tmp = new CFDtoken();
-                tmp->setString(oneToken);
-                ret->addChild(tmp);
-                oneToken.clear();
-
-                withinToken = false;
+                addStringToken(ret->myArena, &tokenList, tokenStart, readPtr);
+                tokenStart = nullptr;
             }
+            readPtr += (commentLen > 0) ? commentLen : 1;
         }
         else if ((aLetter == '(') || (aLetter == ')') || (aLetter == '{') || (aLetter == '}'))
         {
-            if (withinToken)
+            if (tokenStart != nullptr)
             {
-                CFDtoken * tmp = new CFDtoken();
-                tmp->setString(oneToken);
-                ret->addChild(tmp);
-                oneToken.clear();
-
-                withinToken = false;
+                addStringToken(ret->myArena, &tokenList, tokenStart, readPtr);
+                tokenStart = nullptr;
             }
-            CFDtoken * tmp = new CFDtoken();
-            tmp->myType = CFDtokenType::SPECIAL_CHAR;
-            tmp->specialChar = aLetter;
-            ret->addChild(tmp);
+            CFDtoken * tmp = ret->myArena->newToken();
+            tmp->setSpecialChar(aLetter);
+            tokenList.append(tmp);
+            readPtr++;
         }
         else
         {
-            if (!withinToken)
+            if (tokenStart == nullptr)
             {
-                oneToken.clear();
-                withinToken = true;
+                tokenStart = readPtr;
             }
-            oneToken.append(aLetter);
+            readPtr++;
         }
     }
 
-    if (withinToken)
+    if (tokenStart != nullptr)
+    {
+        addStringToken(ret->myArena, &tokenList, tokenStart, endPtr);
+    }
+
+    CFDtoken ** rootChildren = ret->myArena->newChildSpan(tokenList.size());
+    for (int i = 0; i < tokenList.size(); i++)
     {
-        CFDtoken * tmp = new CFDtoken();
-        tmp->setString(oneToken);
-        ret->addChild(tmp);
+        rootChildren[i] = tokenList.at(i);
     }
+    ret->setChildren(CFDtokenType::TREE_NODE, rootChildren, tokenList.size());
 
     return ret;
 }
@@ -204,7 +308,7 @@ CFDtoken * CFDtoken::lexifyString(QByteArray * rawInput)
 bool CFDtoken::parseTokenStream(CFDtoken * rootToken)
 {
     //First, we perform {} and () matching to create data subnodes
-    if (collapseParenTokens(rootToken) == false)
+    if (buildTokenTree(rootToken) == false)
     {
         return false;
     }
@@ -214,152 +318,163 @@ bool CFDtoken::parseTokenStream(CFDtoken * rootToken)
     return true;
 }
 
-QLinkedList<CFDtoken *>::iterator CFDtoken::insertParentToken(
-        CFDtoken * rootToken,
-        QLinkedList<CFDtoken *>::iterator start,
-        QLinkedList<CFDtoken *>::iterator end)
+bool CFDtoken::readVectorList(QByteArray * rawInput, int width, QVector<double> * output)
 {
-    if ((*start)->getParent() != (*end)->getParent())
-    {
-        return rootToken->childList.end();
-    }
-    if ((*start)->getParent() != rootToken)
-    {
-        return rootToken->childList.end();
-    }
-
-    CFDtoken * tmpNode = (*start);
-    start = rootToken->childList.erase(start);
-    delete tmpNode;
+    CFDlistScanner theScanner(rawInput);
+    if (!theScanner.seekDataList()) return false;
+    return theScanner.readVectors(width, output);
+}
 
-    tmpNode = (*end);
-    end = rootToken->childList.erase(end);
-    delete tmpNode;
+bool CFDtoken::readScalarList(QByteArray * rawInput, QVector<double> * output)
+{
+    CFDlistScanner theScanner(rawInput);
+    if (!theScanner.seekDataList()) return false;
+    return theScanner.readScalars(output);
+}
 
-    QLinkedList<CFDtoken *>::iterator workPtr = start;
-    CFDtoken * newTreeNode = new CFDtoken();
-    newTreeNode->setParent(rootToken);
+bool CFDtoken::readLabelList(QByteArray * rawInput, QVector<int> * output)
+{
+    CFDlistScanner theScanner(rawInput);
+    if (!theScanner.seekDataList()) return false;
+    return theScanner.readLabels(output);
+}
 
-    while (workPtr != end)
-    {
-        newTreeNode->addChild(*workPtr);
-        workPtr = rootToken->childList.erase(workPtr);
-    }
-    end = rootToken->childList.insert(end,newTreeNode);
+bool CFDtoken::readFaceList(QByteArray * rawInput, QVector<int> * faceOffsets, QVector<int> * faceIndices)
+{
+    CFDlistScanner theScanner(rawInput);
+    if (!theScanner.seekDataList()) return false;
+    return theScanner.readFaces(faceOffsets, faceIndices);
+}
 
-    return end;
+bool CFDtoken::readPatchList(QByteArray * rawInput, QList<QByteArray> * patchNames, QList<QByteArray> * patchTypes,
+                             QVector<int> * startFaces, QVector<int> * faceCounts)
+{
+    CFDlistScanner theScanner(rawInput);
+    if (!theScanner.seekDataList()) return false;
+    return theScanner.readPatches(patchNames, patchTypes, startFaces, faceCounts);
 }
 
-bool CFDtoken::collapseParenTokens(CFDtoken * rootToken)
+int CFDtoken::commentLength(const char * startPtr, const char * endPtr)
 {
-    bool atFirstNode = true;
-    bool foundOne = true;
+    //Returns the length of the comment starting at startPtr, or 0 if none
+    //An unclosed /* comment runs to the end of the input
 
-    QLinkedList<CFDtoken *>::iterator startItr = rootToken->childList.begin();
-    QLinkedList<CFDtoken *>::iterator endItr = startItr;
+    if ((*startPtr != '/') || (startPtr + 1 == endPtr)) return 0;
 
-    while (foundOne)
+    const char * readPtr = startPtr + 1;
+    if (*readPtr == '/')
     {
-        foundOne = false;
-        bool expectDataArray = false;
-
-        while (startItr != rootToken->childList.end() &&
-               !(*startItr)->isParenToken())
+        while ((readPtr != endPtr) && (*readPtr != '\n')) readPtr++;
+        return static_cast<int>(readPtr - startPtr);
+    }
+    if (*readPtr == '*')
+    {
+        readPtr++;
+        while (readPtr != endPtr)
         {
-            startItr++;
-            atFirstNode = false; //Note: Can move this if it slows things too much
+            if ((*readPtr == '*') && (readPtr + 1 != endPtr) && (*(readPtr + 1) == '/'))
+            {
+                return static_cast<int>(readPtr + 2 - startPtr);
+            }
+            readPtr++;
         }
+        return static_cast<int>(endPtr - startPtr);
+    }
+    return 0;
+}
 
-        if (startItr == rootToken->childList.end())
-        {
-            return true;
-        }
+void CFDtoken::addStringToken(CFDtokenArena * theArena, QVector<CFDtoken *> * tokenList,
+                              const char * strStart, const char * strEnd)
+{
+    CFDtoken * tmp = theArena->newToken();
+    tmp->setString(strStart, static_cast<int>(strEnd - strStart));
+    tokenList->append(tmp);
+}
 
-        endItr = startItr;
-        char startParen = (*startItr)->specialChar;
-        if ((startParen == '}') || (startParen == ')'))
-        {
-            return false;
-        }
-        int nowDepth = 1;
+bool CFDtoken::buildTokenTree(CFDtoken * rootToken)
+{
+    //Matches {} and () in one pass, using a stack of open parens.
+    //Tokens waiting for their closing paren are held in pendingTokens,
+    //and each finished node gets its children as one contiguous span.
 
-        endItr++;
-        while ((endItr != rootToken->childList.end()) && (foundOne == false))
-        {
-            if ((*endItr)->isParenToken())
-            {
-                char endParen = (*endItr)->specialChar;
+    if (rootToken->myArena == nullptr) return false;
+    CFDtokenArena * theArena = rootToken->myArena;
 
-                if ((endParen == '{') || (endParen == '('))
-                {
-                    nowDepth++;
-                }
+    QVector<CFDtoken *> pendingTokens;
+    QVector<int> openStarts;
+    QVector<char> openParens;
 
-                if ((endParen == '}') || (endParen == ')'))
-                {
-                    nowDepth--;
-                    if (nowDepth < 0)
-                    {
-                        return false;
-                    }
+    pendingTokens.reserve(rootToken->myChildCount);
 
-                    if (nowDepth == 0)
-                    {
-                        if ((startParen == '{') && (endParen == '}'))
-                        {
-                            foundOne = true;
-                        }
-                        else if ((startParen == '(') && (endParen == ')'))
-                        {
-                            foundOne = true;
-                            expectDataArray = true;
-                        }
-                    }
-                }
-            }
-            if (foundOne == false)
-            {
-                endItr++;
-            }
+    for (CFDtoken * aToken : rootToken->getChildList())
+    {
+        if (!aToken->isParenToken())
+        {
+            pendingTokens.append(aToken);
+            continue;
         }
 
-        if (endItr == rootToken->childList.end())
+        char aParen = aToken->specialChar;
+        if ((aParen == '{') || (aParen == '('))
         {
-            return false;
+            openStarts.append(pendingTokens.size());
+            openParens.append(aParen);
+            continue;
         }
 
-        startItr = insertParentToken(rootToken,startItr,endItr);
+        if (openParens.isEmpty()) return false;
 
-        if (!collapseParenTokens(*startItr))
+        char startParen = openParens.takeLast();
+        int startIndex = openStarts.takeLast();
+
+        if ((startParen == '(') != (aParen == ')')) return false;
+
+        int childCount = pendingTokens.size() - startIndex;
+        CFDtoken ** childSpan = theArena->newChildSpan(childCount);
+        for (int i = 0; i < childCount; i++)
         {
-            return false;
+            childSpan[i] = pendingTokens.at(startIndex + i);
         }
+        pendingTokens.resize(startIndex);
 
-        if (expectDataArray)
+        CFDtoken * newTreeNode = theArena->newToken();
+        if (startParen == '(')
         {
-            (*startItr)->setAsDataArray();
+            newTreeNode->setChildren(CFDtokenType::DATA_ARRAY, childSpan, childCount);
 
-            if (!atFirstNode)
+            //Lists may be prefixed by their size, which we check and drop
+            int parentStart = openStarts.isEmpty() ? 0 : openStarts.last();
+            if (pendingTokens.size() > parentStart)
             {
-                QLinkedList<CFDtoken *>::iterator beforeItr = startItr;
-                beforeItr--;
-
-                if ((*beforeItr)->getType() == CFDtokenType::INT)
+                CFDtoken * beforeToken = pendingTokens.last();
+                if (beforeToken->getType() == CFDtokenType::INT)
                 {
-                    CFDtoken * expectedIntNode = (*beforeItr);
-                    rootToken->childList.erase(beforeItr);
-                    int numInArray = expectedIntNode->getIntVal();
-                    delete expectedIntNode;
-
-                    if (numInArray != (*startItr)->getChildSize())
+                    if (beforeToken->getIntVal() != childCount)
                     {
                         return false;
                     }
+                    pendingTokens.removeLast();
                 }
             }
         }
+        else
+        {
+            newTreeNode->setChildren(CFDtokenType::TREE_NODE, childSpan, childCount);
+        }
+
+        pendingTokens.append(newTreeNode);
     }
-    return false;
+
+    if (!openParens.isEmpty()) return false;
+
+    CFDtoken ** rootChildren = theArena->newChildSpan(pendingTokens.size());
+    for (int i = 0; i < pendingTokens.size(); i++)
+    {
+        rootChildren[i] = pendingTokens.at(i);
+    }
+    rootToken->setChildren(CFDtokenType::TREE_NODE, rootChildren, pendingTokens.size());
+
+    return true;
 }
 
 bool CFDtoken::isParenToken()
@@ -376,80 +491,51 @@ bool CFDtoken::isParenToken()
     return false;
 }
 
-void CFDtoken::nullfiyContent()
+void CFDtoken::setString(const char * strStart, int strLen)
 {
-    myType = CFDtokenType::INVALID;
-    myString.clear();
-    myInt = 0;
-    myFloat = 0.0;
+    myType = CFDtokenType::STRING;
+    myStrStart = strStart;
+    myStrLen = strLen;
 
-    while (!childList.isEmpty())
+    if (strLen < 1) return;
+
+    //Most tokens are words, and are rejected by the first character
+    char firstChar = *strStart;
+    if (!std::isdigit(static_cast<unsigned char>(firstChar)) &&
+            (firstChar != '-') && (firstChar != '+') && (firstChar != '.'))
     {
-        CFDtoken * aChild = childList.takeLast();
-        delete aChild;
+        return;
     }
-}
-
-void CFDtoken::setInt(int newVal)
-{
-    nullfiyContent();
-    myType = CFDtokenType::INT;
-    myInt = newVal;
-}
-
-void CFDtoken::setFloat(double newVal)
-{
-    nullfiyContent();
-    myType = CFDtokenType::FLOAT;
-    myFloat = newVal;
-}
-
-void CFDtoken::setString(QByteArray newVal)
-{
-    nullfiyContent();
-    myType = CFDtokenType::STRING;
-    myString = newVal;
-
-    bool okCheck;
-    myInt = myString.toInt(&okCheck);
 
-    if (okCheck)
+    qint64 labelVal;
+    if (CFDnumberScanner::readWholeLabel(strStart, strLen, &labelVal) &&
+            (labelVal >= std::numeric_limits<int>::min()) && (labelVal <= std::numeric_limits<int>::max()))
     {
+        myInt = static_cast<int>(labelVal);
         myType = CFDtokenType::INT;
         return;
     }
 
-    myFloat = myString.toDouble(&okCheck);
-
-    if (okCheck)
+    if (CFDnumberScanner::readWholeDouble(strStart, strLen, &myFloat))
     {
         myType = CFDtokenType::FLOAT;
     }
 }
 
-void CFDtoken::addChild(CFDtoken * newChild)
+void CFDtoken::setSpecialChar(char newChar)
 {
-    if ((myType != CFDtokenType::TREE_NODE) &&
-            (myType != CFDtokenType::DATA_ARRAY))
-    {
-        nullfiyContent();
-        myType = CFDtokenType::TREE_NODE;
-    }
-    newChild->setParent(this);
-    childList.append(newChild);
+    myType = CFDtokenType::SPECIAL_CHAR;
+    specialChar = newChar;
 }
 
-void CFDtoken::setAsDataArray()
+void CFDtoken::setChildren(CFDtokenType newType, CFDtoken ** childStart, int childCount)
 {
-    if ((myType != CFDtokenType::TREE_NODE) &&
-            (myType != CFDtokenType::DATA_ARRAY))
+    myType = newType;
+    myChildren = childStart;
+    myChildCount = childCount;
+
+    for (int i = 0; i < childCount; i++)
     {
-        nullfiyContent();
+        childStart[i]->myParent = this;
     }
-    myType = CFDtokenType::DATA_ARRAY;
-}
-
-void CFDtoken::setParent(CFDtoken * newParent)
-{
-    myParent = newParent;
 }
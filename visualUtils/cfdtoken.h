@@ -37,7 +37,8 @@
 #define CFDTOKEN_H
 
 #include <QByteArray>
-#include <QLinkedList>
+#include <QVector>
+#include <QList>
 
 #include <cctype>
 
@@ -47,6 +48,10 @@
 //TODO Note: Int and float types might be vulnerable to overflow,
 //check the setString function if you wish to change this
 
+//Note: All tokens of one parse live in a CFDtokenArena owned by the root token
+//returned from lexifyString. Only delete the root. Deleting the root frees the
+//whole tree at once, without visiting each node.
+
 enum class CFDtokenType
 {
     STRING,
@@ -58,6 +63,51 @@ enum class CFDtokenType
     SPECIAL_CHAR
 };
 
+class CFDtoken;
+
+class CFDtokenSpan
+{
+public:
+    CFDtokenSpan(CFDtoken * const * start, int size);
+
+    CFDtoken * const * begin() const;
+    CFDtoken * const * end() const;
+    CFDtoken * const * cbegin() const;
+    CFDtoken * const * cend() const;
+    CFDtoken * at(int index) const;
+    int size() const;
+    bool isEmpty() const;
+
+private:
+    CFDtoken * const * myStart;
+    int mySize;
+};
+
+class CFDtokenArena
+{
+public:
+    explicit CFDtokenArena(const QByteArray &source);
+    ~CFDtokenArena();
+
+    CFDtoken * newToken();
+    CFDtoken ** newChildSpan(int size);
+
+private:
+    constexpr static const int TOKEN_BLOCK_SIZE = 16384;
+    constexpr static const int CHILD_BLOCK_SIZE = 65536;
+
+    //Note: Holding the source keeps the string tokens valid,
+    //QByteArray is implicitly shared so this is not a deep copy
+    QByteArray mySource;
+
+    QVector<void *> tokenBlocks;
+    QVector<void *> childBlocks;
+    int tokensLeftInBlock = 0;
+    int childrenLeftInBlock = 0;
+    CFDtoken * nextToken = nullptr;
+    CFDtoken ** nextChild = nullptr;
+};
+
 class CFDtoken
 {
 public:
@@ -68,7 +118,7 @@ public:
     int getIntVal();
     double getFloatVal();
     QByteArray getStringVal();
-    QLinkedList<CFDtoken *> getChildList();
+    CFDtokenSpan getChildList();
     int getChildSize();
     CFDtoken * getParent();
 
@@ -78,33 +128,40 @@ public:
     static CFDtoken * lexifyString(QByteArray * rawInput);
     static bool parseTokenStream(CFDtoken * rootToken);
 
-private:
-    void nullfiyContent();
+    //Fast readers for the main data list of a mesh or field file
+    //These do not build a token tree, see cfdlistscanner.h
+    static bool readVectorList(QByteArray * rawInput, int width, QVector<double> * output);
+    static bool readScalarList(QByteArray * rawInput, QVector<double> * output);
+    static bool readLabelList(QByteArray * rawInput, QVector<int> * output);
+    static bool readFaceList(QByteArray * rawInput, QVector<int> * faceOffsets, QVector<int> * faceIndices);
+    static bool readPatchList(QByteArray * rawInput, QList<QByteArray> * patchNames, QList<QByteArray> * patchTypes,
+                              QVector<int> * startFaces, QVector<int> * faceCounts);
 
-    void setInt(int newVal);
-    void setFloat(double newVal);
-    void setString(QByteArray newVal);
-    void addChild(CFDtoken * newChild);
-    void setAsDataArray();
-    void setParent(CFDtoken * newParent);
+private:
+    void setString(const char * strStart, int strLen);
+    void setSpecialChar(char newChar);
+    void setChildren(CFDtokenType newType, CFDtoken ** childStart, int childCount);
 
-    static bool collapseParenTokens(CFDtoken * rootToken);
-    static QLinkedList<CFDtoken *>::iterator insertParentToken(
-            CFDtoken * rootToken,
-            QLinkedList<CFDtoken *>::iterator start,
-            QLinkedList<CFDtoken *>::iterator end);
+    static int commentLength(const char * startPtr, const char * endPtr);
+    static void addStringToken(CFDtokenArena * theArena, QVector<CFDtoken *> * tokenList,
+                               const char * strStart, const char * strEnd);
+    static bool buildTokenTree(CFDtoken * rootToken);
 
     bool isParenToken();
 
-    CFDtokenType myType;
+    CFDtokenType myType = CFDtokenType::INVALID;
 
     CFDtoken * myParent = nullptr;
-    QLinkedList<CFDtoken *> childList;
-    QByteArray myString;
-    int myInt;
-    double myFloat;
+    CFDtokenArena * myArena = nullptr;
+    CFDtoken ** myChildren = nullptr;
+    int myChildCount = 0;
+
+    const char * myStrStart = nullptr;
+    int myStrLen = 0;
+    int myInt = 0;
+    double myFloat = 0.0;
 
-    char specialChar;
+    char specialChar = 0;
 };
 
 #endif // CFDTOKEN_H
@@ -35,6 +35,8 @@
 
 #include "decompresswrapper.h"
 
+#include <limits>
+
 DeCompressWrapper::DeCompressWrapper(QByteArray *ref)
 {
     myRefArray = ref;
@@ -42,54 +44,122 @@ DeCompressWrapper::DeCompressWrapper(QByteArray *ref)
 
 QByteArray * DeCompressWrapper::getDecompressedFile()
 {
-    QByteArray * myResultArray = nullptr;
-
     if (myRefArray == nullptr)
     {
         return nullptr;
     }
 
-    QTemporaryFile compressedFile;
-    if (!compressedFile.open())
+    if (!hasGzipHeader())
     {
-        return nullptr;
+        return new QByteArray(*myRefArray);
     }
-    QByteArray qFileName = compressedFile.fileName().toLatin1();
-    const char * realFileName = qFileName.data();
-    compressedFile.write(*myRefArray);
-    compressedFile.close();
 
-    gzFile compressHandle = gzopen(realFileName, "rb");
+    QByteArray * myResultArray = new QByteArray();
 
-    myResultArray = new QByteArray();
+    //A truncated or corrupt file has junk for a size, so an impossible size is not reserved
+    qint64 expectedSize = getExpectedSize();
+    if ((expectedSize > 0) && (expectedSize <= static_cast<qint64>(myRefArray->size()) * DECOMPRESS_MAX_RATIO))
+    {
+        myResultArray->reserve(static_cast<int>(expectedSize));
+    }
 
-    int resultVal = 1;
+    z_stream zStream;
+    zStream.zalloc = Z_NULL;
+    zStream.zfree = Z_NULL;
+    zStream.opaque = Z_NULL;
+    zStream.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(myRefArray->constData()));
+    zStream.avail_in = static_cast<uInt>(myRefArray->size());
 
-    while (resultVal > 0)
+    //Note: 16 + MAX_WBITS means gzip format only
+    if (inflateInit2(&zStream, 16 + MAX_WBITS) != Z_OK)
     {
-        char dataBuff[DECOMPRESS_READ_BUF_LEN];
-        resultVal = gzread(compressHandle, dataBuff ,DECOMPRESS_READ_BUF_LEN);
-        if (resultVal < 0)
+        delete myResultArray;
+        return nullptr;
+    }
+
+    QByteArray chunkBuffer(DECOMPRESS_CHUNK_LEN, 0);
+    bool inflateOK = true;
+
+    while (true)
+    {
+        zStream.next_out = reinterpret_cast<Bytef *>(chunkBuffer.data());
+        zStream.avail_out = DECOMPRESS_CHUNK_LEN;
+
+        int resultVal = inflate(&zStream, Z_NO_FLUSH);
+
+        if ((resultVal != Z_OK) && (resultVal != Z_STREAM_END))
+        {
+            inflateOK = false;
+            break;
+        }
+
+        int chunkLen = DECOMPRESS_CHUNK_LEN - static_cast<int>(zStream.avail_out);
+        myResultArray->append(chunkBuffer.constData(), chunkLen);
+
+        if (resultVal == Z_STREAM_END)
         {
-            delete myResultArray;
-            myResultArray = nullptr;
-            return nullptr;
+            if (!nextMemberFollows(&zStream)) break;
+            inflateReset(&zStream);
+        }
+        else if ((zStream.avail_in == 0) && (chunkLen == 0))
+        {
+            //Input ended before the end of the gzip stream
+            inflateOK = false;
+            break;
         }
-        myResultArray->append(dataBuff, resultVal);
     }
-    gzclose(compressHandle);
+
+    inflateEnd(&zStream);
+
+    if (!inflateOK)
+    {
+        delete myResultArray;
+        return nullptr;
+    }
 
     return myResultArray;
 }
 
+bool DeCompressWrapper::hasGzipHeader()
+{
+    if (myRefArray == nullptr) return false;
+    if (myRefArray->size() < 2) return false;
+
+    return ((static_cast<unsigned char>(myRefArray->at(0)) == 0x1f) &&
+            (static_cast<unsigned char>(myRefArray->at(1)) == 0x8b));
+}
+
+qint64 DeCompressWrapper::getExpectedSize()
+{
+    //The last 4 bytes of a gzip file are the input size, mod 2^32, little-endian
+    //This is only a hint: it is wrong for multi-member or >4GB files
+    if (!hasGzipHeader()) return -1;
+    if (myRefArray->size() < 18) return -1;
+
+    const unsigned char * trailer = reinterpret_cast<const unsigned char *>(myRefArray->constData() + myRefArray->size() - 4);
+    quint32 isize = static_cast<quint32>(trailer[0]) |
+            (static_cast<quint32>(trailer[1]) << 8) |
+            (static_cast<quint32>(trailer[2]) << 16) |
+            (static_cast<quint32>(trailer[3]) << 24);
+
+    if (isize > static_cast<quint32>(std::numeric_limits<int>::max())) return -1;
+    return static_cast<qint64>(isize);
+}
+
+bool DeCompressWrapper::nextMemberFollows(z_stream * zStream)
+{
+    //gzip files may be several gzip members in a row
+    if (zStream->avail_in < 2) return false;
+    return ((zStream->next_in[0] == 0x1f) && (zStream->next_in[1] == 0x8b));
+}
+
 QByteArray * DeCompressWrapper::getConditionalCompressedFileContents(QString fileName)
 {
     QFile uncompressedFile(fileName);
     if (uncompressedFile.exists())
     {
-        QByteArray * ret = nullptr;
         uncompressedFile.open(QIODevice::ReadOnly);
-        *ret = uncompressedFile.readAll();
+        QByteArray * ret = new QByteArray(uncompressedFile.readAll());
         uncompressedFile.close();
         return ret;
     }
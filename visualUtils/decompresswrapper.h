@@ -44,10 +44,15 @@
     #include <zlib.h>
 #endif
 
-#define DECOMPRESS_READ_BUF_LEN 1024
+#define DECOMPRESS_CHUNK_LEN 262144
+//Deflate cannot expand data by more than this ratio
+#define DECOMPRESS_MAX_RATIO 1032
 
 #include <QByteArray>
-#include <QTemporaryFile>
+#include <QFile>
+
+//Note: Inflation is done in memory with zlib's z_stream.
+//Input without a gzip header is passed through unchanged, as gzread would.
 
 class DeCompressWrapper
 {
@@ -55,9 +60,15 @@ public:
     explicit DeCompressWrapper(QByteArray *ref);
 
     QByteArray * getDecompressedFile();
+
+    bool hasGzipHeader();
+    qint64 getExpectedSize();
+
     static QByteArray * getConditionalCompressedFileContents(QString fileName);
 
 private:
+    bool nextMemberFollows(z_stream * zStream);
+
     QByteArray * myRefArray = nullptr;
 };
 
@@ -37,6 +37,10 @@
 
 #include "visualUtils/cfdglcanvas2D.h"
 
+#include <QDoubleSpinBox>
+#include <QVBoxLayout>
+#include <QHBoxLayout>
+
 ResultField2dWindow::ResultField2dWindow(CWEcaseInstance * theCase, RESULT_ENTRY *resultDesc, QWidget *parent):
     ResultVisualPopup(theCase, resultDesc, parent) {}
 
@@ -57,27 +61,56 @@ void ResultField2dWindow::initializeView()
     performStandardInit(neededFiles);
 }
 
-void ResultField2dWindow::allFilesLoaded()
+void ResultField2dWindow::allDataLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
-    CFDglCanvas * myCanvas;
-    changeDisplayFrameTenant(myCanvas = new CFDglCanvas2D());
+    //The canvas sits above a control for the color scale clip percentile
+    QWidget * displayArea = new QWidget();
+    QVBoxLayout * displayLayout = new QVBoxLayout(displayArea);
+    displayLayout->setContentsMargins(0, 0, 0, 0);
+
+    myCanvas = new CFDglCanvas2D();
+    displayLayout->addWidget(myCanvas, 1);
+
+    QHBoxLayout * clipLayout = new QHBoxLayout();
+    QDoubleSpinBox * clipControl = new QDoubleSpinBox();
+    clipControl->setRange(0.0, 25.0);
+    clipControl->setSingleStep(0.1);
+    clipControl->setDecimals(2);
+    clipControl->setSuffix(" %");
+    clipControl->setValue(myCanvas->getClipPercentile());
+    clipLayout->addWidget(new QLabel("Color scale clips values outside percentiles:"));
+    clipLayout->addWidget(clipControl);
+    clipLayout->addStretch();
+    displayLayout->addLayout(clipLayout);
+
+    changeDisplayFrameTenant(displayArea);
 
-    myCanvas->loadMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["owner"]);
+    myCanvas->loadMeshData(getMeshData());
 
     if (!myCanvas->getDisplayError().isEmpty())
     {
+        myCanvas = nullptr;
         changeDisplayFrameTenant(new QLabel("Error: Data for 2D mesh is unreadable. Please reset and try again."));
         return;
     }
 
-    myCanvas->loadFieldData(fileBuffers["data"], getResultObj().values);
+    myCanvas->loadFieldData(getFieldData());
 
     if (!myCanvas->displayAvailData())
     {
+        myCanvas = nullptr;
         changeDisplayFrameTenant(new QLabel("Error: Data for 2D field visual is unreadable. Please reset and try again."));
         return;
     }
+
+    QObject::connect(clipControl, SIGNAL(valueChanged(double)),
+                     this, SLOT(clipPercentileChanged(double)));
+}
+
+void ResultField2dWindow::clipPercentileChanged(double newPercentile)
+{
+    if (myCanvas == nullptr) return;
+    myCanvas->setClipPercentile(newPercentile);
 }
@@ -39,17 +39,24 @@
 #include "visualUtils/resultvisualpopup.h"
 
 struct RESULT_ENTRY;
+class CFDglCanvas;
 
 class ResultField2dWindow : public ResultVisualPopup
 {
+    Q_OBJECT
 public:
     ResultField2dWindow(CWEcaseInstance * theCase, RESULT_ENTRY * resultDesc, QWidget *parent = nullptr);
     ~ResultField2dWindow();
 
     virtual void initializeView();
 
+private slots:
+    void clipPercentileChanged(double newPercentile);
+
 private:
-    virtual void allFilesLoaded();
+    virtual void allDataLoaded();
+
+    CFDglCanvas * myCanvas = nullptr;
 };
 
 #endif // RESULTFIELD2DWINDOW_H
@@ -52,15 +52,14 @@ void ResultMesh2dWindow::initializeView()
     performStandardInit(neededFiles);
 }
 
-void ResultMesh2dWindow::allFilesLoaded()
+void ResultMesh2dWindow::allDataLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
     CFDglCanvas * myCanvas;
     changeDisplayFrameTenant(myCanvas = new CFDglCanvas2D());
 
-    myCanvas->loadMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["owner"]);
+    myCanvas->loadMeshData(getMeshData());
 
     if (!myCanvas->displayAvailData())
     {
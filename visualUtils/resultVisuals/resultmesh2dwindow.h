@@ -53,7 +53,7 @@ public:
     virtual void initializeView();
 
 private:
-    virtual void allFilesLoaded();
+    virtual void allDataLoaded();
 };
 
 #endif // RESULTMESH2DWINDOW_H
@@ -37,6 +37,9 @@
 
 #include "visualUtils/cfdglcanvas3D.h"
 
+#include <QListWidget>
+#include <QHBoxLayout>
+
 ResultMesh3dWindow::ResultMesh3dWindow(CWEcaseInstance * theCase, RESULT_ENTRY *resultDesc, QWidget *parent):
     ResultVisualPopup(theCase, resultDesc, parent) {}
 
@@ -48,24 +51,58 @@ void ResultMesh3dWindow::initializeView()
     neededFiles["points"] = "/constant/polyMesh/points.gz";
     neededFiles["faces"] = "/constant/polyMesh/faces.gz";
     neededFiles["owner"] = "/constant/polyMesh/owner.gz";
+    neededFiles["boundary"] = "/constant/polyMesh/boundary.gz";
 
     performStandardInit(neededFiles);
 }
 
-void ResultMesh3dWindow::allFilesLoaded()
+void ResultMesh3dWindow::allDataLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
 
-    //TODO: Redo for 3D
-    CFDglCanvas * myCanvas;
-    changeDisplayFrameTenant(myCanvas = new CFDglCanvas3D());
+    //The canvas sits beside a list of boundary patches, each of which can be hidden
+    QWidget * displayArea = new QWidget();
+    QHBoxLayout * displayLayout = new QHBoxLayout(displayArea);
+    displayLayout->setContentsMargins(0, 0, 0, 0);
+
+    myCanvas = new CFDglCanvas3D();
+    displayLayout->addWidget(myCanvas, 1);
+
+    QListWidget * patchControl = new QListWidget();
+    displayLayout->addWidget(patchControl);
+
+    changeDisplayFrameTenant(displayArea);
 
-    myCanvas->loadMeshData(fileBuffers["points"], fileBuffers["faces"], fileBuffers["owner"]);
+    myCanvas->loadMeshData(getMeshData());
 
     if (!myCanvas->displayAvailData())
     {
+        myCanvas = nullptr;
         changeDisplayFrameTenant(new QLabel("Error: Data for 3D mesh result is unreadable. Please reset and try again."));
         return;
     }
+
+    QStringList patchNames = myCanvas->getPatchNames();
+    if (patchNames.isEmpty())
+    {
+        patchControl->hide();
+        return;
+    }
+
+    for (QString aName : patchNames)
+    {
+        QListWidgetItem * patchItem = new QListWidgetItem(aName, patchControl);
+        patchItem->setFlags(patchItem->flags() | Qt::ItemIsUserCheckable);
+        patchItem->setCheckState(myCanvas->patchIsVisible(aName) ? Qt::Checked : Qt::Unchecked);
+    }
+    patchControl->setMaximumWidth(patchControl->sizeHintForColumn(0) + 40);
+
+    QObject::connect(patchControl, SIGNAL(itemChanged(QListWidgetItem*)),
+                     this, SLOT(patchToggled(QListWidgetItem*)));
+}
+
+void ResultMesh3dWindow::patchToggled(QListWidgetItem * patchItem)
+{
+    if (myCanvas == nullptr) return;
+    myCanvas->setPatchVisible(patchItem->text(), (patchItem->checkState() == Qt::Checked));
 }
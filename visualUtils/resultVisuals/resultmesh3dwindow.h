@@ -40,7 +40,8 @@
 #include <QWidget>
 #include "visualUtils/resultvisualpopup.h"
 
-class CFDglCanvas;
+class CFDglCanvas3D;
+class QListWidgetItem;
 struct RESULT_ENTRY;
 
 class ResultMesh3dWindow : public ResultVisualPopup
@@ -52,8 +53,13 @@ public:
 
     virtual void initializeView();
 
+private slots:
+    void patchToggled(QListWidgetItem * patchItem);
+
 private:
-    virtual void allFilesLoaded();
+    virtual void allDataLoaded();
+
+    CFDglCanvas3D * myCanvas = nullptr;
 };
 
 #endif // RESULTMESH3DWINDOW_H
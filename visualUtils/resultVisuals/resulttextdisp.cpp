@@ -50,14 +50,14 @@ void ResultTextDisplay::initializeView()
     performStandardInit(neededFiles);
 }
 
-void ResultTextDisplay::allFilesLoaded()
+void ResultTextDisplay::allDataLoaded()
 {
     QObject::disconnect(this);
-    QMap<QString, QByteArray *> fileBuffers = getFileBuffers();
+    QMap<QString, QByteArray> fileBuffers = getFileBuffers();
 
     QPlainTextEdit * myDisplay;
 
-    QString theText = QString::fromLatin1(*(fileBuffers["text"]));
+    QString theText = QString::fromLatin1(fileBuffers.value("text"));
     changeDisplayFrameTenant(myDisplay = new QPlainTextEdit(theText));
     myDisplay->setReadOnly(true);
 }
@@ -49,7 +49,7 @@ public:
     virtual void initializeView();
 
 private:
-    virtual void allFilesLoaded();
+    virtual void allDataLoaded();
 };
 
 #endif // RESULTTEXTDISP_H
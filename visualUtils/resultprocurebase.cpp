@@ -36,6 +36,9 @@
 #include "resultprocurebase.h"
 #include "cwe_globals.h"
 #include "decompresswrapper.h"
+#include "cfdbuffercache.h"
+#include "cfdfetchscheduler.h"
+#include "CFDanalysis/cwefilechangedispatcher.h"
 
 #include "remoteFiles/filetreenode.h"
 #include "remoteFiles/fileoperator.h"
@@ -44,13 +47,7 @@
 
 ResultProcureBase::ResultProcureBase(QWidget *parent) : QWidget(parent) {}
 
-ResultProcureBase::~ResultProcureBase()
-{
-    for (auto itr = myBufferList.cbegin(); itr != myBufferList.cend(); itr++)
-    {
-        delete (*itr);
-    }
-}
+ResultProcureBase::~ResultProcureBase() {}
 
 void ResultProcureBase::initializeWithNeededFiles(FileNodeRef baseFolder, QMap<QString, QString> neededFiles)
 {
@@ -76,6 +73,17 @@ void ResultProcureBase::initializeWithNeededFiles(FileNodeRef baseFolder, QMap<Q
         myFileNodes[fileID] = nil;
     }
 
+    cwe_globals::get_file_dispatcher()->subscribe(myBaseFolder.getFullPath(), this, SLOT(fileChanged(FileNodeRef)));
+    QObject::connect(cwe_globals::get_buffer_cache(), SIGNAL(bufferFetched(QString,QByteArray)),
+                     this, SLOT(cacheBufferFetched(QString,QByteArray)),
+                     Qt::QueuedConnection);
+    QObject::connect(cwe_globals::get_buffer_cache(), SIGNAL(bufferStored(QString)),
+                     this, SLOT(cacheBufferStored(QString)),
+                     Qt::QueuedConnection);
+    QObject::connect(cwe_globals::get_fetch_scheduler(), SIGNAL(fetchFailed(QString)),
+                     this, SLOT(fileFetchFailed(QString)),
+                     Qt::QueuedConnection);
+
     fileChanged(nil);
 }
 
@@ -84,51 +92,175 @@ QMap<QString, FileNodeRef> ResultProcureBase::getFileNodes()
     return myFileNodes;
 }
 
-QMap<QString, QByteArray *> ResultProcureBase::getFileBuffers()
+QMap<QString, QByteArray> ResultProcureBase::getFileBuffers()
 {
     if (!initLoadDone)
     {
         qCDebug(agaveAppLayer, "ERROR: File buffer compute request before files retrieved.");
-        QMap<QString, QByteArray *> empty;
+        QMap<QString, QByteArray> empty;
         return empty;
     }
 
-    if (myBufferList.isEmpty())
-    {
-        computeFileBuffers();
-    }
+    computeFileBuffers();
     return myBufferList;
 }
 
 void ResultProcureBase::computeFileBuffers()
 {
-    myBufferList.clear();
-
     for (QString fileID : myFileNodes.keys())
     {
-        FileNodeRef theFile = myFileNodes.value(fileID);
-        if (!theFile.fileNodeExtant())
+        if (myBufferList.contains(fileID)) continue;
+        if (readyFiles.contains(fileID)) continue;
+
+        if (!inflateFileBuffer(fileID))
         {
-            cwe_globals::displayFatalPopup("Internal Error: result file not loaded after load");
+            cwe_globals::displayFatalPopup("Internal Error: result buffer not loaded after load");
         }
-        QByteArray * rawBuffer = nullptr;
+    }
+}
+
+void ResultProcureBase::releaseFileBuffer(QString fileID)
+{
+    myBufferList.remove(fileID);
+}
+
+void ResultProcureBase::fileArrived(QString fileID)
+{
+    if (!myBufferList.contains(fileID) && !inflateFileBuffer(fileID))
+    {
+        cwe_globals::displayFatalPopup("Internal Error: result buffer not loaded after load");
+    }
+
+    fileBufferReady(fileID, myBufferList.value(fileID));
+}
+
+void ResultProcureBase::fileBufferReady(QString, const QByteArray &)
+{
+    //Note: This is deliberately blank. Override to parse each file on arrival.
+}
+
+QByteArray ResultProcureBase::getStoredFileBuffer(QString fileID)
+{
+    return myFileNodes.value(fileID).getFileBuffer();
+}
+
+bool ResultProcureBase::storedFileIsCompressed(QString fileID)
+{
+    return myFileNodes.value(fileID).getFileName().endsWith(".gz");
+}
+
+bool ResultProcureBase::inflateFileBuffer(QString fileID)
+{
+    FileNodeRef theFile = myFileNodes.value(fileID);
+    if (!theFile.fileNodeExtant())
+    {
+        cwe_globals::displayFatalPopup("Internal Error: result file not loaded after load");
+    }
+
+    //Note: QByteArray is shared, not copied, so an uncompressed file
+    //is held once, by both the file node and this list
+    if (!storedFileIsCompressed(fileID))
+    {
+        myBufferList[fileID] = theFile.getFileBuffer();
+        return true;
+    }
+
+    QByteArray compressedBuffer = theFile.getFileBuffer();
+    DeCompressWrapper realPoints(&compressedBuffer);
+    QByteArray * rawBuffer = realPoints.getDecompressedFile();
+    if (rawBuffer == nullptr) return false;
+
+    myBufferList[fileID] = std::move(*rawBuffer);
+    delete rawBuffer;
+    return true;
+}
+
+void ResultProcureBase::deliverReadyBuffers()
+{
+    //Each file is handed on as soon as it arrives,
+    //while the others may still be downloading
+    for (QString fileID : myFileNodes.keys())
+    {
+        if (readyFiles.contains(fileID)) continue;
+
+        FileNodeRef aNode = myFileNodes.value(fileID);
+        if (aNode.isNil()) continue;
+        if (!aNode.fileBufferLoaded()) continue;
 
-        if (theFile.getFileName().endsWith(".gz"))
+        if (!cachedFiles.contains(fileID))
         {
-            QByteArray compressedBuffer = theFile.getFileBuffer();
-            DeCompressWrapper realPoints(&compressedBuffer);
-            rawBuffer = realPoints.getDecompressedFile();
+            cwe_globals::get_buffer_cache()->storeBuffer(aNode, aNode.getFileBuffer());
         }
-        else
+
+        readyFiles.insert(fileID);
+        fileArrived(fileID);
+
+        //Once handed on, the file node need not keep the raw file,
+        //if it can be read back from the local cache
+        if (cwe_globals::get_buffer_cache()->hasBuffer(aNode))
         {
-            rawBuffer = new QByteArray(theFile.getFileBuffer());
+            aNode.setFileBuffer(nullptr);
         }
+    }
+}
+
+void ResultProcureBase::cacheBufferFetched(QString remotePath, QByteArray fileBuffer)
+{
+    QString fileID;
+    for (QString anID : cacheReadsPending)
+    {
+        if (myFileNodes.value(anID).getFullPath() == remotePath) fileID = anID;
+    }
+    if (fileID.isEmpty()) return;
+
+    cacheReadsPending.remove(fileID);
+    cacheChecked.insert(fileID);
+
+    FileNodeRef fileNode = myFileNodes.value(fileID);
+    if (!fileBuffer.isEmpty() && !fileNode.isNil() && !fileNode.fileBufferLoaded())
+    {
+        fileNode.setFileBuffer(&fileBuffer);
+        cachedFiles.insert(fileID);
+    }
+
+    if (initLoadDone) return;
+    if (checkForAndSeekFiles())
+    {
+        initLoadDone = true;
+        allFilesLoaded();
+    }
+}
+
+void ResultProcureBase::cacheBufferStored(QString remotePath)
+{
+    //A file written to the cache after it was handed on can now be let go
+    for (QString fileID : readyFiles)
+    {
+        FileNodeRef fileNode = myFileNodes.value(fileID);
+        if (fileNode.isNil()) continue;
+        if (fileNode.getFullPath() != remotePath) continue;
 
-        if (rawBuffer == nullptr)
+        if (fileNode.fileBufferLoaded() && cwe_globals::get_buffer_cache()->hasBuffer(fileNode))
         {
-            cwe_globals::displayFatalPopup("Internal Error: result buffer not loaded after load");
+            fileNode.setFileBuffer(nullptr);
         }
-        myBufferList[fileID] = rawBuffer;
+    }
+}
+
+void ResultProcureBase::fileFetchFailed(QString remotePath)
+{
+    if (initLoadDone) return;
+
+    for (QString fileID : myFileNodes.keys())
+    {
+        FileNodeRef fileNode = myFileNodes.value(fileID);
+        if (fileNode.isNil()) continue;
+        if (fileNode.getFullPath() != remotePath) continue;
+        if (fileNode.fileBufferLoaded()) return;
+
+        QObject::disconnect(this);
+        initialFailure();
+        return;
     }
 }
 
@@ -225,33 +357,53 @@ bool ResultProcureBase::checkForAndSeekFiles()
             }
 
             myFileNodes[fileID] = targetFileNode;
-            QObject::connect(cwe_globals::get_file_handle(), SIGNAL(fileSystemChange(FileNodeRef)),
-                             this, SLOT(fileChanged(FileNodeRef)),
-                             Qt::QueuedConnection);
             fileNode = targetFileNode;
         }
 
+        if (readyFiles.contains(fileID)) continue;
+
+        //Result files are looked for in the local cache before any download.
+        //The cache is read on the load service, and the file is asked for again once it answers.
+        if (cacheReadsPending.contains(fileID)) continue;
+        if (!fileNode.fileBufferLoaded() && !cacheChecked.contains(fileID) &&
+                !cwe_globals::get_fetch_scheduler()->fileIsPending(fileNode))
+        {
+            if (cwe_globals::get_buffer_cache()->fetchBuffer(fileNode))
+            {
+                cacheReadsPending.insert(fileID);
+                continue;
+            }
+            cacheChecked.insert(fileID);
+        }
+
         if (!fileNode.fileBufferLoaded())
         {
-            cwe_globals::get_file_handle()->sendDownloadBuffReq(fileNode);
+            cwe_globals::get_fetch_scheduler()->requestFile(fileNode, FetchPriority::VISIBLE);
         }
     }
 
-    for (FileNodeRef aNode : myFileNodes)
+    deliverReadyBuffers();
+
+    for (QString fileID : myFileNodes.keys())
     {
-        if (aNode.isNil()) return false;
-        if (!aNode.fileBufferLoaded()) return false;
+        if (myFileNodes.value(fileID).isNil()) return false;
+        if (!readyFiles.contains(fileID)) return false;
     }
 
     return true;
 }
 
 FileNodeRef ResultProcureBase::getFinalResultFolder()
+{
+    return findFinalResultFolder(myBaseFolder);
+}
+
+FileNodeRef ResultProcureBase::findFinalResultFolder(FileNodeRef baseFolder)
 {
     double biggestNum = -1.0;
     FileNodeRef targetChild;
 
-    for (FileNodeRef childNode : myBaseFolder.getChildList())
+    for (FileNodeRef childNode : baseFolder.getChildList())
     {
         if (childNode.getFileType() != FileType::DIR) continue;
 
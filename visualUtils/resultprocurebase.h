@@ -38,6 +38,7 @@
 
 #include <QWidget>
 #include <QMap>
+#include <QSet>
 
 #include "remoteFiles/filenoderef.h"
 
@@ -56,13 +57,25 @@ public:
     void initializeWithNeededFiles(FileNodeRef baseFolder, QMap<QString, QString> neededFiles);
     //Note: needed files is a map: internalID => path relative to base folder
 
+    static FileNodeRef findFinalResultFolder(FileNodeRef baseFolder);
+
 protected:
     virtual void allFilesLoaded() = 0;
 
     QMap<QString, FileNodeRef> getFileNodes();
-    QMap<QString, QByteArray *> getFileBuffers();
+    QMap<QString, QByteArray> getFileBuffers();
 
     void computeFileBuffers();
+    void releaseFileBuffer(QString fileID);
+
+    virtual void fileArrived(QString fileID);
+    //Note: fileArrived is called once per file, as soon as that file has
+    //arrived. This is before allFilesLoaded. By default, the file is inflated
+    //here and passed to fileBufferReady.
+    virtual void fileBufferReady(QString fileID, const QByteArray &fileBuffer);
+
+    QByteArray getStoredFileBuffer(QString fileID);
+    bool storedFileIsCompressed(QString fileID);
 
     virtual void underlyingDataChanged(QString fileID) = 0;
     //Note: input to the above method might be an empty string
@@ -72,17 +85,26 @@ protected:
 
 private slots:
     void fileChanged(FileNodeRef changedFile);
+    void cacheBufferFetched(QString remotePath, QByteArray fileBuffer);
+    void cacheBufferStored(QString remotePath);
+    void fileFetchFailed(QString remotePath);
 
 private:
     bool checkForAndSeekFiles(); //Returns true if all files loaded
     FileNodeRef getFinalResultFolder();
     QString getIDfromNode(FileNodeRef fileNode);
+    bool inflateFileBuffer(QString fileID);
+    void deliverReadyBuffers();
 
     FileNodeRef myBaseFolder;
 
     QMap<QString, QString> myFileNames;
     QMap<QString, FileNodeRef> myFileNodes;
-    QMap<QString, QByteArray *> myBufferList;
+    QMap<QString, QByteArray> myBufferList;
+    QSet<QString> readyFiles;
+    QSet<QString> cachedFiles;
+    QSet<QString> cacheReadsPending;
+    QSet<QString> cacheChecked;
     bool initLoadDone = false;
 };
 
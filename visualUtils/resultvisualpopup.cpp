@@ -41,6 +41,8 @@
 #include "CFDanalysis/cwecaseinstance.h"
 #include "CFDanalysis/cweanalysistype.h"
 #include "cwe_globals.h"
+#include "cfdloadservice.h"
+#include "cfdmeshcache.h"
 
 ResultVisualPopup::ResultVisualPopup(CWEcaseInstance *theCase, RESULT_ENTRY * resultDesc, QWidget *parent) :
     ResultProcureBase(parent),
@@ -65,6 +67,13 @@ ResultVisualPopup::ResultVisualPopup(CWEcaseInstance *theCase, RESULT_ENTRY * re
 
 ResultVisualPopup::~ResultVisualPopup()
 {
+    //Results of parses still running are not needed anymore
+    for (CFDparseTask * aTask : pendingTasks)
+    {
+        cwe_globals::get_load_service()->cancelTask(aTask);
+    }
+    pendingTasks.clear();
+
     if (displayFrameTenant != nullptr) delete displayFrameTenant;
     if (resultFrameLayout != nullptr) delete resultFrameLayout;
     delete ui;
@@ -80,7 +89,35 @@ void ResultVisualPopup::performStandardInit(QMap<QString, QString> neededFiles)
         return;
     }
 
+    //A mesh already parsed for this stage is shared, and its files are not fetched again
+    QMap<QString, QString> meshFiles;
+    for (QString meshFileID : {"points", "faces", "owner", "boundary"})
+    {
+        if (neededFiles.contains(meshFileID)) meshFiles[meshFileID] = neededFiles.value(meshFileID);
+    }
+
+    if (!meshFiles.isEmpty())
+    {
+        meshStageFolder = trueBaseFolder.getFullPath();
+        meshCacheKey = CFDmeshCache::makeMeshKey(meshStageFolder, meshFiles);
+        cachedMesh = cwe_globals::get_mesh_cache()->findMesh(meshCacheKey);
+
+        if (!cachedMesh.isNull())
+        {
+            for (QString meshFileID : meshFiles.keys())
+            {
+                neededFiles.remove(meshFileID);
+            }
+        }
+    }
+
     setupResultDisplay(myCase->getCaseName(), myCase->getMyType()->getDisplayName(), resultObj.displayName);
+
+    if (neededFiles.isEmpty())
+    {
+        allDataLoaded();
+        return;
+    }
     initializeWithNeededFiles(trueBaseFolder, neededFiles);
 }
 
@@ -110,11 +147,118 @@ void ResultVisualPopup::underlyingDataChanged(QString )
     //Note: This is deliberately blank. This result popup is static once the image displays.
 }
 
+void ResultVisualPopup::fileArrived(QString fileID)
+{
+    //Mesh and field files are inflated and parsed by the load service,
+    //off the GUI thread. Their text is never kept here.
+    if ((fileID == "points") || (fileID == "faces") || (fileID == "owner") ||
+            (fileID == "boundary") || (fileID == "data"))
+    {
+        CFDparseTask * newTask = cwe_globals::get_load_service()->submitParse(fileID,
+                                                    getStoredFileBuffer(fileID),
+                                                    storedFileIsCompressed(fileID),
+                                                    resultObj.values,
+                                                    this, SLOT(parseTaskDone(CFDparseTask*)));
+        //taskDone is queued, so it cannot be handled before this append
+        pendingTasks.append(newTask);
+        return;
+    }
+
+    ResultProcureBase::fileArrived(fileID);
+    filesParsed++;
+    updateLoadProgress();
+}
+
+void ResultVisualPopup::parseTaskDone(CFDparseTask * theTask)
+{
+    if (!pendingTasks.removeOne(theTask)) return;
+
+    if (theTask->getFileID() == "data")
+    {
+        myFieldData = theTask->getFieldPart();
+    }
+    else
+    {
+        if (myMeshData.isNull())
+        {
+            myMeshData = QSharedPointer<CFDmeshData>(new CFDmeshData());
+        }
+        if (!theTask->getMeshPart().isNull())
+        {
+            myMeshData->takePartsFrom(theTask->getMeshPart().data());
+        }
+    }
+
+    if (!theTask->getError().isEmpty())
+    {
+        qCDebug(agaveAppLayer, "Result file parse error: %s", qPrintable(theTask->getError()));
+    }
+
+    filesParsed++;
+    updateLoadProgress();
+
+    if (filesAllArrived && pendingTasks.isEmpty())
+    {
+        finishLoading();
+    }
+}
+
+void ResultVisualPopup::allFilesLoaded()
+{
+    filesAllArrived = true;
+    if (!pendingTasks.isEmpty()) return;
+
+    finishLoading();
+}
+
+void ResultVisualPopup::finishLoading()
+{
+    //A newly parsed mesh is offered to other popups on the same stage
+    if (cachedMesh.isNull() && !myMeshData.isNull() && !meshCacheKey.isEmpty())
+    {
+        if (myMeshData->checkMesh())
+        {
+            //Internal faces are never drawn when the boundary is known
+            myMeshData->keepBoundaryFaces();
+            cachedMesh = myMeshData;
+            myMeshData.clear();
+            cwe_globals::get_mesh_cache()->insertMesh(meshStageFolder, meshCacheKey, cachedMesh);
+        }
+    }
+
+    allDataLoaded();
+}
+
+void ResultVisualPopup::updateLoadProgress()
+{
+    QLabel * loadingLabel = qobject_cast<QLabel *>(displayFrameTenant);
+    if (loadingLabel == nullptr) return;
+
+    loadingLabel->setText(QString("Loading result data: %1 of %2 files read. Please Wait.")
+                          .arg(filesParsed).arg(getFileNodes().size()));
+}
+
 RESULT_ENTRY ResultVisualPopup::getResultObj()
 {
     return resultObj;
 }
 
+QSharedPointer<const CFDmeshData> ResultVisualPopup::getMeshData()
+{
+    if (!cachedMesh.isNull()) return cachedMesh;
+
+    if (!myMeshData.isNull())
+    {
+        myMeshData->checkMesh();
+    }
+    return myMeshData;
+}
+
+QSharedPointer<const CFDfieldData> ResultVisualPopup::getFieldData()
+{
+    return myFieldData;
+}
+
 void ResultVisualPopup::baseFolderRemoved()
 {
     QObject::disconnect(this);
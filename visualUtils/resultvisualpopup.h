@@ -44,8 +44,10 @@
 #include "CFDanalysis/cweanalysistype.h"
 
 #include "resultprocurebase.h"
+#include "cfdmeshdata.h"
 
 class CWEcaseInstance;
+class CFDparseTask;
 
 namespace Ui {
 class ResultVisualPopup;
@@ -66,14 +68,22 @@ protected:
     void changeDisplayFrameTenant(QWidget * newDisplay);
     virtual void initialFailure();
     virtual void underlyingDataChanged(QString fileID);
+    virtual void fileArrived(QString fileID);
+    virtual void allFilesLoaded();
+    virtual void allDataLoaded() = 0;
+    //Note: allDataLoaded is called on the GUI thread once every file has
+    //arrived and all background parsing is done
 
     RESULT_ENTRY getResultObj();
+    QSharedPointer<const CFDmeshData> getMeshData();
+    QSharedPointer<const CFDfieldData> getFieldData();
 
 protected slots:
     virtual void baseFolderRemoved();
 
 private slots:
     void closeButtonClicked();
+    void parseTaskDone(CFDparseTask * theTask);
 
 private:
     Ui::ResultVisualPopup *ui;
@@ -83,6 +93,19 @@ private:
 
     QWidget * displayFrameTenant = nullptr;
     QHBoxLayout * resultFrameLayout = nullptr;
+
+    QSharedPointer<CFDmeshData> myMeshData;
+    QSharedPointer<CFDfieldData> myFieldData;
+    QSharedPointer<const CFDmeshData> cachedMesh;
+    QString meshStageFolder;
+    QString meshCacheKey;
+
+    void updateLoadProgress();
+    void finishLoading();
+
+    QList<CFDparseTask *> pendingTasks;
+    int filesParsed = 0;
+    bool filesAllArrived = false;
 };
 
 #endif // RESULTVISUALPOPUP_H